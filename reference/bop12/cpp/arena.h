@@ -0,0 +1,71 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// Arena Class - Bump allocator for objects of type T
+// ------------------------------------------------------------------
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace cbop {
+
+/** @brief Storage for objects of type T with stable addresses
+ *
+ * The objects are stored in blocks of BlockSize elements that are allocated on demand. reset () discards
+ * the stored objects but keeps the blocks, so once the arena has grown to the size needed by the
+ * computations it serves it does not allocate memory anymore. The stored objects are never destroyed,
+ * so T must not own any resource.
+ */
+template <class T, size_t BlockSize = 256>
+class Arena {
+public:
+	Arena () : blocks (), current (0), used (BlockSize) {}
+	~Arena () { for (size_t i = 0; i < blocks.size (); ++i) ::operator delete (blocks[i]); }
+
+	/** Store a copy of value into the arena, returning its address */
+	T* store (const T& value)
+	{
+		if (used == BlockSize)
+			nextBlock ();
+		return new (blocks[current] + used++) T (value);
+	}
+	/** Discard all the stored objects, keeping the allocated blocks for future use */
+	void reset () { current = 0; used = blocks.empty () ? BlockSize : 0; }
+	/** Number of objects that can be stored without allocating memory */
+	size_t capacity () const { return blocks.size () * BlockSize; }
+
+private:
+	/** The blocks where the objects are stored */
+	std::vector<T*> blocks;
+	/** Block where the next object is stored and number of objects already stored in that block */
+	size_t current;
+	size_t used;
+
+	void nextBlock ()
+	{
+		if (current + 1 < blocks.size ()) {
+			++current;
+		} else {
+			blocks.push_back (static_cast<T*> (::operator new (BlockSize * sizeof (T))));
+			current = blocks.size () - 1;
+		}
+		used = 0;
+	}
+
+	// Arenas are not copyable
+	Arena (const Arena&);
+	Arena& operator= (const Arena&);
+};
+
+} // end of namespace cbop
+#endif
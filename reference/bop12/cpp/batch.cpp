@@ -0,0 +1,500 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "batch.h"
+
+using namespace cbop;
+
+namespace { // start of anonymous namespace
+
+/** Jobs [begin, end) pending for a thread. The owner takes jobs from the front, thieves from the back */
+struct WorkRange {
+	WorkRange () : begin (0), end (0) {}
+	std::mutex mutex;
+	size_t begin;
+	size_t end;
+};
+
+/** Take the next job of range r. Return false if r is empty */
+bool takeJob (WorkRange& r, size_t& job)
+{
+	std::lock_guard<std::mutex> lock (r.mutex);
+	if (r.begin == r.end)
+		return false;
+	job = r.begin++;
+	return true;
+}
+
+/** Move half of the jobs of another range to the (empty) range of thread t. Return false if all the ranges are empty */
+bool steal (std::vector<WorkRange>& ranges, size_t t)
+{
+	for (size_t i = 1; i < ranges.size (); i++) {
+		WorkRange& victim = ranges[(t + i) % ranges.size ()];
+		size_t begin, end;
+		{
+			std::lock_guard<std::mutex> lock (victim.mutex);
+			if (victim.begin == victim.end)
+				continue;
+			end = victim.end;
+			begin = victim.end - (victim.end - victim.begin + 1) / 2;
+			victim.end = begin;
+		}
+		std::lock_guard<std::mutex> lock (ranges[t].mutex);
+		ranges[t].begin = begin;
+		ranges[t].end = end;
+		return true;
+	}
+	return false;
+}
+
+/** Compute job with engine, or without the sweep if it is an intersection that cbop::compute does not sweep */
+void computeJob (BooleanOpImp* engine, const BooleanOpJob& job, Polygon& result, BooleanOpStatus& status)
+{
+	if (job.operation == INTERSECTION && convexIntersection (*job.subject, *job.clipping, result)) {
+		status = SUCCESS;
+		return;
+	}
+	engine->run (*job.subject, *job.clipping, result, job.operation);
+	status = engine->status ();
+}
+
+/** The jobs of a batch. Every thread takes the jobs of its range and then steals the jobs of the others */
+class JobsTask : public BatchTask {
+public:
+	JobsTask (const std::vector<BooleanOpImp*>& e, std::vector<WorkRange>& r, const std::vector<BooleanOpJob>& j,
+	          std::vector<Polygon>& res, std::vector<BooleanOpStatus>& st) : engines (e), ranges (r), jobs (j), results (res), status (st) {}
+	void run (size_t t)
+	{
+		size_t j;
+		do {
+			while (takeJob (ranges[t], j))
+				computeJob (engines[t], jobs[j], results[j], status[j]);
+		} while (steal (ranges, t));
+	}
+private:
+	const std::vector<BooleanOpImp*>& engines;
+	std::vector<WorkRange>& ranges;
+	const std::vector<BooleanOpJob>& jobs;
+	std::vector<Polygon>& results;
+	std::vector<BooleanOpStatus>& status;
+};
+
+/** Interleave the bits of the 16 bit values x and y (Z-order curve) */
+unsigned int mortonCode (unsigned int x, unsigned int y)
+{
+	unsigned int code = 0;
+	for (unsigned int b = 0; b < 16; b++)
+		code |= (((x >> b) & 1) << (2 * b)) | (((y >> b) & 1) << (2 * b + 1));
+	return code;
+}
+
+/** Order of the polygons along the Z-order curve of the centers of their bounding boxes */
+std::vector<size_t> spatialOrder (const std::vector<Polygon>& polygons)
+{
+	std::vector<Bbox_2> boxes (polygons.size ());
+	Bbox_2 all;
+	for (size_t i = 0; i < polygons.size (); i++) {
+		boxes[i] = polygons[i].bbox ();
+		all = (i == 0) ? boxes[i] : all + boxes[i];
+	}
+	const double scale = 65535.0;
+	double width = all.xmax () - all.xmin ();
+	double height = all.ymax () - all.ymin ();
+	std::vector<std::pair<unsigned int, size_t> > codes (polygons.size ());
+	for (size_t i = 0; i < polygons.size (); i++) {
+		double cx = (boxes[i].xmin () + boxes[i].xmax ()) / 2 - all.xmin ();
+		double cy = (boxes[i].ymin () + boxes[i].ymax ()) / 2 - all.ymin ();
+		unsigned int x = (width > 0) ? (unsigned int) (cx / width * scale) : 0;
+		unsigned int y = (height > 0) ? (unsigned int) (cy / height * scale) : 0;
+		codes[i] = std::make_pair (mortonCode (x, y), i);
+	}
+	std::sort (codes.begin (), codes.end ());
+	std::vector<size_t> order (polygons.size ());
+	for (size_t i = 0; i < polygons.size (); i++)
+		order[i] = codes[i].second;
+	return order;
+}
+
+/** An edge of an operation split into slabs, with its range of abscissas */
+struct SlabEdge {
+	Segment_2 segment;
+	double xmin, xmax;
+};
+
+/** Is p an endpoint of the edge e? */
+inline bool endpoint (const SlabEdge& e, const Point_2& p)
+{
+	return p == e.segment.source () || p == e.segment.target ();
+}
+
+/** @brief Does the sweep of the whole plane leave the edge e untouched until it reaches the abscissa x?
+ *
+ * The sweep only divides or overlaps e where it touches another edge, once both are in sl. So it leaves e untouched
+ * if e does not touch (as findIntersection tells) the edges starting before x, but at endpoints of both edges.
+ * work counts the edges visited
+ */
+bool untouchedBefore (const std::vector<SlabEdge>& edges, size_t e, double x, size_t& work)
+{
+	const SlabEdge& a = edges[e];
+	Point_2 ip0, ip1;
+	work += edges.size ();
+	for (size_t i = 0; i < edges.size (); i++) {
+		const SlabEdge& b = edges[i];
+		if (i == e || b.xmin >= x || DoubleKernel::apart (a.segment.source (), a.segment.target (), b.segment.source (), b.segment.target ()))
+			continue;
+		int n = findIntersection (a.segment, b.segment, ip0, ip1);
+		if (n == 2 || (n == 1 && !(endpoint (a, ip0) && endpoint (b, ip0))))
+			return false;
+	}
+	return true;
+}
+
+/** Edges visited per edge of the operation when searching a slab boundary */
+const size_t boundaryWork = 16;
+
+/** @brief Search of the boundaries of the slabs of an operation, the thread t places the boundary t + 1
+ *
+ * The boundary s is placed in a gap between the abscissas of two consecutive vertices, around the gap that leaves
+ * s / n of the vertices to its left. The windows[s - 1] and windows[s] (quantiles of a sample of the abscissas of
+ * the vertices) bound the gaps tried, from the closest to the ideal one outwards. The first gap whose crossing edges
+ * the sweep of the whole plane leaves untouched until it reaches the middle of the gap (see untouchedBefore) is
+ * chosen. If none is found after visiting boundaryWork edges per edge of the operation the boundary is left as NaN:
+ * it is dropped, and its slab merged with the next one. The vertices to the right of lastX are not swept
+ */
+class BoundariesTask : public BatchTask {
+public:
+	BoundariesTask (const std::vector<SlabEdge>& e, const std::vector<double>& w, const std::vector<double>& q, double l) :
+		edges (e), windows (w), ideals (q), lastX (l), boundaries (q.size (), std::numeric_limits<double>::quiet_NaN ()) {}
+	void run (size_t t)
+	{
+		// the gaps of the window, between the abscissas xs, and the one containing the ideal boundary
+		std::vector<double> xs;
+		for (size_t i = 0; i < edges.size (); i++) {
+			const double x = edges[i].segment.source ().x ();
+			if (x >= windows[t] && x <= windows[t + 1] && x <= lastX)
+				xs.push_back (x);
+		}
+		std::sort (xs.begin (), xs.end ());
+		xs.erase (std::unique (xs.begin (), xs.end ()), xs.end ());
+		if (xs.size () < 2)
+			return;
+		const size_t ideal = std::min<size_t> (std::max<size_t> (std::upper_bound (xs.begin (), xs.end (), ideals[t]) - xs.begin (), 1), xs.size () - 1);
+		size_t work = 0;
+		for (size_t k = 0; k < 2 * xs.size () && work < boundaryWork * edges.size (); k++) {
+			// the gaps ideal, ideal + 1, ideal - 1, ideal + 2...
+			const size_t g = (k % 2) ? ideal + (k + 1) / 2 : ideal - k / 2;
+			if (g < 1 || g >= xs.size ())
+				continue;
+			const double x = (xs[g - 1] + xs[g]) / 2;
+			if (!(x > xs[g - 1] && x < xs[g]))
+				continue;
+			bool untouched = true;
+			work += edges.size ();
+			for (size_t i = 0; i < edges.size () && untouched; i++)
+				if (edges[i].xmin < x && edges[i].xmax > x)
+					untouched = untouchedBefore (edges, i, x, work);
+			if (untouched) {
+				boundaries[t] = x;
+				return;
+			}
+		}
+	}
+	const std::vector<SlabEdge>& edges;
+	const std::vector<double>& windows;
+	const std::vector<double>& ideals;
+	double lastX;
+	std::vector<double> boundaries;
+};
+
+/** The sweeps of the slabs of an operation, the thread t sweeps the slab t */
+class SlabsTask : public BatchTask {
+public:
+	SlabsTask (const std::vector<BooleanOpImp*>& e, const Polygon& s, const Polygon& c, BooleanOpType o, const std::vector<double>& b) :
+		engines (e), subj (s), clip (c), op (o), boundaries (b) {}
+	void run (size_t t)
+	{
+		const double inf = std::numeric_limits<double>::infinity ();
+		engines[t]->sweepSlab (subj, clip, op, (t > 0) ? boundaries[t - 1] : -inf, (t < boundaries.size ()) ? boundaries[t] : inf);
+	}
+private:
+	const std::vector<BooleanOpImp*>& engines;
+	const Polygon& subj;
+	const Polygon& clip;
+	BooleanOpType op;
+	const std::vector<double>& boundaries;
+};
+
+/** @brief Do the edges crossing the start of a slab (starts) have the state they have at the end of the previous slab?
+ *
+ * ends are the right events of the edges crossing the end of the previous slab. The boundaries are placed so that
+ * they do, this check catches what the search of the boundaries cannot foresee
+ */
+bool sameState (const std::vector<SweepEvent*>& ends, const std::vector<SlabStart>& starts)
+{
+	if (ends.size () != starts.size ())
+		return false;
+	for (size_t i = 0; i < ends.size (); i++) {
+		const SweepEvent* le = ends[i]->otherEvent;
+		if (le->point != starts[i].le->point || le->type != NORMAL || le->inOut != starts[i].inOut || le->otherInOut != starts[i].otherInOut)
+			return false;
+	}
+	return true;
+}
+
+/** Replace e by the event it stands for in replaced, which is sorted, until it does not stand for another one */
+SweepEvent* replacement (const std::vector<std::pair<SweepEvent*, SweepEvent*> >& replaced, SweepEvent* e)
+{
+	for (;;) {
+		std::vector<std::pair<SweepEvent*, SweepEvent*> >::const_iterator it =
+			std::lower_bound (replaced.begin (), replaced.end (), std::make_pair (e, (SweepEvent*) 0));
+		if (it == replaced.end () || it->first != e)
+			return e;
+		e = it->second;
+	}
+}
+
+} // end of anonymous namespace
+
+BatchBooleanOp::BatchBooleanOp (unsigned int nthreads) : engines (), threads (), mutex (), wake (), finished (), task (0), active (0),
+  running (0), generation (0), stopping (false)
+{
+	if (nthreads == 0)
+		nthreads = std::thread::hardware_concurrency ();
+	if (nthreads == 0)
+		nthreads = 1;
+	for (unsigned int i = 0; i < nthreads; i++)
+		engines.push_back (new BooleanOpImp ());
+	for (unsigned int i = 1; i < nthreads; i++)
+		threads.push_back (std::thread (&BatchBooleanOp::work, this, i));
+}
+
+BatchBooleanOp::~BatchBooleanOp ()
+{
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		stopping = true;
+	}
+	wake.notify_all ();
+	for (unsigned int i = 0; i < threads.size (); i++)
+		threads[i].join ();
+	for (unsigned int i = 0; i < engines.size (); i++)
+		delete engines[i];
+}
+
+void BatchBooleanOp::run (BatchTask& t, size_t n)
+{
+	if (n > 1) {
+		{
+			std::lock_guard<std::mutex> lock (mutex);
+			task = &t;
+			active = n;
+			running = n - 1;
+			++generation;
+		}
+		wake.notify_all ();
+	}
+	t.run (0);
+	if (n > 1) {
+		std::unique_lock<std::mutex> lock (mutex);
+		while (running > 0)
+			finished.wait (lock);
+	}
+}
+
+void BatchBooleanOp::work (size_t t)
+{
+	unsigned long done = 0; // tasks seen by this thread
+	for (;;) {
+		BatchTask* current;
+		{
+			std::unique_lock<std::mutex> lock (mutex);
+			while (generation == done && !stopping)
+				wake.wait (lock);
+			if (stopping)
+				return;
+			done = generation;
+			if (t >= active)
+				continue;
+			current = task;
+		}
+		current->run (t);
+		std::lock_guard<std::mutex> lock (mutex);
+		if (--running == 0)
+			finished.notify_one ();
+	}
+}
+
+void BatchBooleanOp::compute (const std::vector<BooleanOpJob>& jobs, std::vector<Polygon>& results, std::vector<BooleanOpStatus>& status)
+{
+	results.assign (jobs.size (), Polygon ());
+	status.assign (jobs.size (), SUCCESS);
+	size_t nthreads = std::min (engines.size (), jobs.size ());
+	if (nthreads <= 1) {
+		for (size_t j = 0; j < jobs.size (); j++)
+			computeJob (engines[0], jobs[j], results[j], status[j]);
+		return;
+	}
+	std::vector<WorkRange> ranges (nthreads);
+	for (size_t t = 0; t < nthreads; t++) {
+		ranges[t].begin = jobs.size () * t / nthreads;
+		ranges[t].end = jobs.size () * (t + 1) / nthreads;
+	}
+	JobsTask task (engines, ranges, jobs, results, status);
+	run (task, nthreads);
+}
+
+BooleanOpStatus BatchBooleanOp::computeUnion (const std::vector<Polygon>& polygons, Polygon& result)
+{
+	if (polygons.empty ()) {
+		result.clear ();
+		return SUCCESS;
+	}
+	std::vector<size_t> order = spatialOrder (polygons);
+	// the first level unites pairs of input polygons, without copying them
+	std::vector<BooleanOpJob> jobs;
+	for (size_t i = 0; i + 1 < order.size (); i += 2)
+		jobs.push_back (BooleanOpJob (polygons[order[i]], polygons[order[i + 1]], UNION));
+	std::vector<Polygon> level, next;
+	std::vector<BooleanOpStatus> status;
+	compute (jobs, level, status);
+	if (order.size () % 2)
+		level.push_back (polygons[order.back ()]);
+	for (;;) {
+		for (size_t i = 0; i < status.size (); i++)
+			if (status[i] != SUCCESS)
+				return status[i];
+		if (level.size () == 1)
+			break;
+		jobs.clear ();
+		for (size_t i = 0; i + 1 < level.size (); i += 2)
+			jobs.push_back (BooleanOpJob (level[i], level[i + 1], UNION));
+		compute (jobs, next, status);
+		if (level.size () % 2)
+			next.push_back (std::move (level.back ()));
+		level.swap (next);
+	}
+	result = std::move (level[0]);
+	return SUCCESS;
+}
+
+std::vector<double> BatchBooleanOp::slabBoundaries (const Polygon& subj, const Polygon& clip, double lastX)
+{
+	std::vector<SlabEdge> edges;
+	edges.reserve (subj.nvertices () + clip.nvertices ());
+	for (int p = 0; p < 2; p++) {
+		const Polygon& pol = p ? clip : subj;
+		for (unsigned int i = 0; i < pol.ncontours (); i++)
+			for (unsigned int j = 0; j < pol.contour (i).nvertices (); j++) {
+				SlabEdge e;
+				e.segment = pol.contour (i).segment (j);
+				e.xmin = e.segment.min ().x ();
+				e.xmax = e.segment.max ().x ();
+				edges.push_back (e);
+			}
+	}
+	// the quantiles of a sample of the abscissas of the vertices: the ideal boundaries and the windows around them
+	const size_t n = engines.size ();
+	const size_t step = std::max<size_t> (edges.size () / (64 * n), 1);
+	std::vector<double> sample;
+	for (size_t i = 0; i < edges.size (); i += step)
+		if (edges[i].segment.source ().x () <= lastX)
+			sample.push_back (edges[i].segment.source ().x ());
+	std::sort (sample.begin (), sample.end ());
+	if (sample.size () < 2 * n)
+		return std::vector<double> ();
+	std::vector<double> windows (n), ideals (n - 1);
+	for (size_t s = 0; s < n; s++)
+		windows[s] = sample[sample.size () * (2 * s + 1) / (2 * n)];
+	for (size_t s = 1; s < n; s++)
+		ideals[s - 1] = sample[sample.size () * s / n];
+	BoundariesTask task (edges, windows, ideals, lastX);
+	run (task, n - 1);
+	std::vector<double> boundaries;
+	for (size_t s = 0; s < task.boundaries.size (); s++)
+		if (!std::isnan (task.boundaries[s]) && (boundaries.empty () || task.boundaries[s] > boundaries.back ()))
+			boundaries.push_back (task.boundaries[s]);
+		else
+			++_slabCounters.droppedBoundaries;
+	return boundaries;
+}
+
+BooleanOpStatus BatchBooleanOp::computeInSlabs (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op)
+{
+	_slabCounters = SlabCounters ();
+	Bbox_2 subjectBB = subj.bbox ();
+	Bbox_2 clippingBB = clip.bbox ();
+	const double inf = std::numeric_limits<double>::infinity ();
+	double lastX = inf; // the sweep stops there (optimization 2)
+	if (op == INTERSECTION)
+		lastX = std::min (subjectBB.xmax (), clippingBB.xmax ());
+	else if (op == DIFFERENCE)
+		lastX = subjectBB.xmax ();
+	std::vector<double> boundaries;
+	if (engines.size () > 1 && subj.ncontours () * clip.ncontours () > 0 &&
+		subjectBB.xmin () <= clippingBB.xmax () && clippingBB.xmin () <= subjectBB.xmax () &&
+		subjectBB.ymin () <= clippingBB.ymax () && clippingBB.ymin () <= subjectBB.ymax ())
+		boundaries = slabBoundaries (subj, clip, lastX);
+	if (boundaries.empty ()) { // trivial operation, too few vertices or no boundary found
+		engines[0]->run (subj, clip, result, op);
+		return engines[0]->status ();
+	}
+
+	// sweep the slabs, the edges crossing the boundaries have the state that sweepSlab gives them
+	const size_t nslabs = boundaries.size () + 1;
+	_slabCounters.slabs = nslabs;
+	SlabsTask task (engines, subj, clip, op, boundaries);
+	run (task, nslabs);
+	for (size_t s = 0; s < nslabs; s++) {
+		if (engines[s]->dividedOutside () || (s > 0 && !sameState (engines[s - 1]->endEdges (), engines[s]->startEdges ()))) {
+			_slabCounters.serial = true;
+			engines[0]->run (subj, clip, result, op);
+			return engines[0]->status ();
+		}
+		if (engines[s]->status () != SUCCESS)
+			return engines[s]->status ();
+	}
+
+	// join the edges crossing every boundary: the left event of the edge crossing the end of a slab and the right
+	// event of the edge crossing the start of the next slab become the endpoints of the edge, with the fields of
+	// the left event at the end of the next slab. The left event at the start of the next slab is discarded
+	std::vector<std::pair<SweepEvent*, SweepEvent*> > replaced; // (discarded event or placeholder, event it stands for)
+	for (size_t s = 0; s + 1 < nslabs; s++) {
+		const std::vector<SweepEvent*>& ends = engines[s]->endEdges ();
+		const std::vector<SlabStart>& starts = engines[s + 1]->startEdges ();
+		for (size_t i = 0; i < ends.size (); i++) {
+			SweepEvent* le = ends[i]->otherEvent;
+			SweepEvent* start = starts[i].le;
+			replaced.push_back (std::make_pair (starts[i].below, le->prevInResult));
+			replaced.push_back (std::make_pair (start, le));
+			le->otherEvent = start->otherEvent;
+			le->otherEvent->otherEvent = le;
+			le->setLine ();
+			le->type = start->type;
+			le->inOut = start->inOut;
+			le->otherInOut = start->otherInOut;
+			le->inResult = start->inResult;
+			le->prevInResult = start->prevInResult;
+		}
+	}
+	std::sort (replaced.begin (), replaced.end ());
+	std::vector<SweepEvent*> events;
+	for (size_t s = 0; s < nslabs; s++) {
+		std::vector<SweepEvent*>& slabEvents = engines[s]->events ();
+		for (size_t i = 0; i < slabEvents.size (); i++) {
+			SweepEvent* e = slabEvents[i];
+			if (e->left && e->prevInResult)
+				e->prevInResult = replacement (replaced, e->prevInResult);
+			events.push_back (e);
+		}
+	}
+	engines[0]->connect (events, result);
+	return engines[0]->status ();
+}
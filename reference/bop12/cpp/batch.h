@@ -0,0 +1,125 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// Batches of independent Boolean operations computed in parallel
+// ------------------------------------------------------------------
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "booleanop.h"
+
+namespace cbop {
+
+/** A Boolean operation of a batch. The polygons are not copied, they must outlive the computation of the batch */
+struct BooleanOpJob {
+	BooleanOpJob (const Polygon& subj, const Polygon& clip, BooleanOpType op) : subject (&subj), clipping (&clip), operation (op) {}
+	const Polygon* subject;
+	const Polygon* clipping;
+	BooleanOpType operation;
+};
+
+/** How the last BatchBooleanOp::computeInSlabs was computed */
+struct SlabCounters {
+	SlabCounters () : slabs (0), droppedBoundaries (0), serial (false) {}
+	unsigned int slabs;             // slabs swept in parallel, 0 if the operation was not split
+	unsigned int droppedBoundaries; // boundaries for which no place was found, their slabs were merged with the next ones
+	bool serial;                    // was the operation computed serially after sweeping the slabs?
+};
+
+/** Work done by the threads of a BatchBooleanOp: run (t) is called on the thread t */
+struct BatchTask {
+	virtual ~BatchTask () {}
+	virtual void run (size_t t) = 0;
+};
+
+/** @brief Computes batches of independent Boolean operations on several threads
+ *
+ * The threads are started when the object is built and wait for work until it is destroyed, so a batch (and
+ * every level of computeUnion) does not pay for starting threads. The calling thread is the thread 0 of the
+ * pool. Every thread owns a BooleanOpImp engine, kept from one batch to the next. The jobs are split into one
+ * range per thread; a thread that runs out of jobs steals half of the remaining jobs of another thread.
+ * The results do not depend on the number of threads nor on the scheduling: the i-th result and status
+ * always correspond to the i-th job. The intersections that cbop::compute computes without the sweep (of two
+ * rectangles or of two convex polygons) are computed in the same way.
+ */
+class BatchBooleanOp {
+public:
+	/** nthreads == 0 means one thread per hardware thread */
+	explicit BatchBooleanOp (unsigned int nthreads = 0);
+	~BatchBooleanOp ();
+	/** Compute the jobs, results[i] and status[i] are the result and outcome of jobs[i] */
+	void compute (const std::vector<BooleanOpJob>& jobs, std::vector<Polygon>& results, std::vector<BooleanOpStatus>& status);
+	/** @brief Compute the union of polygons
+	 *
+	 * The polygons are sorted along a space-filling curve, so that neighbouring polygons are merged first,
+	 * and united pairwise in a balanced tree. The unions of a level of the tree are computed as a batch.
+	 * If a union fails result is left unmodified and the status of the failure is returned.
+	 */
+	BooleanOpStatus computeUnion (const std::vector<Polygon>& polygons, Polygon& result);
+	/** @brief Compute a single Boolean operation, splitting the plane into up to one vertical slab per thread
+	 *
+	 * The state of the edges crossing a slab boundary at the boundary is worked out before the slabs are swept: the
+	 * threads search in parallel for boundaries, between vertices and leaving about the same number of vertices in
+	 * every slab, such that the sweep of the whole plane does not divide nor overlap the edges crossing them before
+	 * reaching them. Those edges then keep their endpoints up to the boundary, and their fields follow from their
+	 * order, so every thread sweeps its slab (see BooleanOpImp::sweepSlab) exactly as the sweep of the whole plane
+	 * does. The edges crossing the boundaries are joined and the result edges of all the slabs are connected as in
+	 * the serial algorithm, so the result is the same as the one of BooleanOpImp. A boundary for which no place is
+	 * found is dropped; if all are dropped (when long edges crossing each other span the polygons), or a slab does
+	 * not start with the state the previous one leaves, the operation is computed serially.
+	 */
+	BooleanOpStatus computeInSlabs (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op);
+	unsigned int nthreads () const { return engines.size (); }
+	/** How the last computeInSlabs was computed */
+	const SlabCounters& slabCounters () const { return _slabCounters; }
+private:
+	std::vector<BooleanOpImp*> engines;
+	std::vector<std::thread> threads; // the threads 1 to nthreads () - 1
+	std::mutex mutex;
+	std::condition_variable wake;     // a task has been posted or the pool is stopping
+	std::condition_variable finished; // the last thread running the task has finished it
+	BatchTask* task;                  // task being run by the threads 0 to active - 1
+	size_t active;
+	size_t running;                   // threads still running the task, apart from the calling thread
+	unsigned long generation;         // number of tasks posted
+	bool stopping;
+	SlabCounters _slabCounters;
+	/** Run task on the threads 0 to n - 1 and wait until all of them have finished */
+	void run (BatchTask& t, size_t n);
+	/** Body of the thread t: run the tasks posted to it until the pool stops */
+	void work (size_t t);
+	/** Boundaries of the slabs of computeInSlabs, searched in parallel. The sweep stops at lastX */
+	std::vector<double> slabBoundaries (const Polygon& subj, const Polygon& clip, double lastX);
+	// BatchBooleanOps are not copyable
+	BatchBooleanOp (const BatchBooleanOp&);
+	BatchBooleanOp& operator= (const BatchBooleanOp&);
+};
+
+/** Compute a batch of Boolean operations. See BatchBooleanOp */
+inline void compute (const std::vector<BooleanOpJob>& jobs, std::vector<Polygon>& results, std::vector<BooleanOpStatus>& status,
+                     unsigned int nthreads = 0)
+{
+	BatchBooleanOp batch (nthreads);
+	batch.compute (jobs, results, status);
+}
+
+/** Compute the union of polygons. See BatchBooleanOp::computeUnion */
+inline BooleanOpStatus computeUnion (const std::vector<Polygon>& polygons, Polygon& result, unsigned int nthreads = 0)
+{
+	BatchBooleanOp batch (nthreads);
+	return batch.computeUnion (polygons, result);
+}
+
+} // end of namespace cbop
+#endif
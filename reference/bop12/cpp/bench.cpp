@@ -0,0 +1,901 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "booleanop.h"
+#include "batch.h"
+#include "binarypolygon.h"
+#include "polygonwriter.h"
+
+void fatalError (const std::string& message, int exitCode)
+{
+	std::cerr << message;
+	exit (exitCode);
+}
+
+/** Elapsed (wall clock) seconds since an arbitrary origin */
+double wallTime ()
+{
+	return std::chrono::duration<double> (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
+
+/** Compute the operation between every ordered pair of different polygons, serially and with BatchBooleanOp */
+int batchBench (int argc, char* argv[], const std::string& paramError)
+{
+	const std::string ope = "IUDX";
+	if (argc < 7 || ope.find (argv[2][0]) == std::string::npos)
+		fatalError (paramError, 2);
+	cbop::BooleanOpType op = static_cast<cbop::BooleanOpType> (ope.find (argv[2][0]));
+	int nthreads = atoi (argv[3]);
+	int repetitions = atoi (argv[4]);
+	if (nthreads < 0 || repetitions < 1)
+		fatalError (paramError, 2);
+	std::vector<cbop::Polygon> polygons (argc - 5);
+	for (int i = 5; i < argc; i++)
+		if (! polygons[i - 5].open (argv[i]))
+			fatalError (std::string (argv[i]) + " does not exist or has a bad format\n", 3);
+	std::vector<cbop::BooleanOpJob> jobs;
+	for (unsigned int i = 0; i < polygons.size (); i++)
+		for (unsigned int j = 0; j < polygons.size (); j++)
+			if (i != j)
+				jobs.push_back (cbop::BooleanOpJob (polygons[i], polygons[j], op));
+
+	std::vector<cbop::Polygon> results;
+	std::vector<cbop::BooleanOpStatus> status;
+	cbop::BooleanOp engine;
+	double start = wallTime ();
+	for (int r = 0; r < repetitions; r++) {
+		results.assign (jobs.size (), cbop::Polygon ());
+		for (unsigned int j = 0; j < jobs.size (); j++)
+			engine.compute (*jobs[j].subject, *jobs[j].clipping, results[j], op);
+	}
+	double serial = (wallTime () - start) / repetitions;
+	cbop::BatchBooleanOp batch (nthreads);
+	start = wallTime ();
+	for (int r = 0; r < repetitions; r++)
+		batch.compute (jobs, results, status);
+	double parallel = (wallTime () - start) / repetitions;
+	unsigned int failed = 0;
+	for (unsigned int j = 0; j < status.size (); j++)
+		failed += status[j] != cbop::SUCCESS;
+	std::cout << jobs.size () << " jobs (" << failed << " failed), " << batch.nthreads () << " threads\n";
+	std::cout << "serial: " << serial * 1000.0 << " ms, batch: " << parallel * 1000.0 << " ms, speedup: " << serial / parallel << "\n";
+	return 0;
+}
+
+/** @brief Latency of the operations between every ordered pair of different polygons, with compute and with BooleanOp
+ *
+ * Every operation is timed on its own, and the median and the 90th percentile of the times are reported
+ */
+int latencyBench (int argc, char* argv[], const std::string& paramError)
+{
+	const std::string ope = "IUDX";
+	if (argc < 6 || ope.find (argv[2][0]) == std::string::npos)
+		fatalError (paramError, 2);
+	cbop::BooleanOpType op = static_cast<cbop::BooleanOpType> (ope.find (argv[2][0]));
+	int repetitions = atoi (argv[3]);
+	if (repetitions < 1)
+		fatalError (paramError, 2);
+	std::vector<cbop::Polygon> polygons (argc - 4);
+	for (int i = 4; i < argc; i++)
+		if (! polygons[i - 4].open (argv[i]))
+			fatalError (std::string (argv[i]) + " does not exist or has a bad format\n", 3);
+	cbop::BooleanOp engine;
+	for (int useEngine = 0; useEngine < 2; useEngine++) {
+		std::vector<double> times;
+		for (int r = 0; r < repetitions; r++)
+			for (unsigned int i = 0; i < polygons.size (); i++)
+				for (unsigned int j = 0; j < polygons.size (); j++) {
+					if (i == j)
+						continue;
+					cbop::Polygon result;
+					double start = wallTime ();
+					if (useEngine)
+						engine.compute (polygons[i], polygons[j], result, op);
+					else
+						cbop::compute (polygons[i], polygons[j], result, op);
+					times.push_back (wallTime () - start);
+				}
+		std::sort (times.begin (), times.end ());
+		std::cout << (useEngine ? "BooleanOp: " : "compute:   ") << "p50: " << times[times.size () / 2] * 1e6 << " us, p90: "
+		          << times[times.size () * 9 / 10] * 1e6 << " us (" << times.size () << " operations)\n";
+	}
+	return 0;
+}
+
+/** Unite copies of the polygons laid out on a grid, one after another and with computeUnion */
+int unionBench (int argc, char* argv[], const std::string& paramError)
+{
+	if (argc < 5)
+		fatalError (paramError, 2);
+	int nthreads = atoi (argv[2]);
+	int copies = atoi (argv[3]);
+	if (nthreads < 0 || copies < 1)
+		fatalError (paramError, 2);
+	std::vector<cbop::Polygon> polygons;
+	for (int i = 4; i < argc; i++) {
+		cbop::Polygon p;
+		if (! p.open (argv[i]))
+			fatalError (std::string (argv[i]) + " does not exist or has a bad format\n", 3);
+		cbop::Bbox_2 bb = p.bbox ();
+		// neighbouring copies overlap by a fifth of the size of the polygon
+		double dx = (bb.xmax () - bb.xmin ()) * 0.8, dy = (bb.ymax () - bb.ymin ()) * 0.8;
+		for (int c = 0; c < copies; c++) {
+			polygons.push_back (p);
+			polygons.back ().move ((c % 100) * dx, (c / 100) * dy);
+		}
+	}
+	double start = wallTime ();
+	cbop::Polygon sequential;
+	for (unsigned int i = 0; i < polygons.size (); i++) {
+		cbop::Polygon aux;
+		cbop::compute (sequential, polygons[i], aux, cbop::UNION);
+		sequential = aux;
+	}
+	double tsequential = wallTime () - start;
+	cbop::BatchBooleanOp batch (nthreads);
+	cbop::Polygon cascaded;
+	start = wallTime ();
+	cbop::BooleanOpStatus status = batch.computeUnion (polygons, cascaded);
+	double tcascaded = wallTime () - start;
+	std::cout << polygons.size () << " polygons, " << batch.nthreads () << " threads" << (status != cbop::SUCCESS ? " (failed)" : "") << "\n";
+	std::cout << "sequential: " << tsequential * 1000.0 << " ms (" << sequential.nvertices () << " vertices), cascaded: "
+	          << tcascaded * 1000.0 << " ms (" << cascaded.nvertices () << " vertices)\n";
+	return 0;
+}
+
+/** @brief Fan of wedges sharing the apex (0, 0), every three wedges a subject and a clipping wedge are adjacent
+ *
+ * The shared edge of the adjacent wedges overlaps, and the result contours meet at the apex
+ */
+void fan (int n, cbop::Polygon& subj, cbop::Polygon& clip)
+{
+	const double R = 1e6, PI = 3.14159265358979323846;
+	std::vector<cbop::Point_2> rim (3 * n + 1);
+	for (int i = 0; i <= 3 * n; i++) {
+		double angle = 2 * PI * i / (3 * n + 1);
+		rim[i] = cbop::Point_2 (2 * floor (R * cos (angle)), 2 * floor (R * sin (angle)));
+	}
+	for (int i = 0; i < n; i++) {
+		const cbop::Point_2& a = rim[3 * i], b = rim[3 * i + 1], c = rim[3 * i + 2];
+		subj.push_back (cbop::Contour ());
+		subj.back ().add (cbop::Point_2 (0, 0));
+		subj.back ().add (a);
+		subj.back ().add (b);
+		clip.push_back (cbop::Contour ());
+		clip.back ().add (cbop::Point_2 (0, 0));
+		clip.back ().add (cbop::Point_2 (b.x () / 2, b.y () / 2)); // overlaps half of the edge (0,0)-b
+		clip.back ().add (c);
+	}
+}
+
+/** A long subject rectangle and n clipping squares standing on its top edge */
+void comb (int n, cbop::Polygon& subj, cbop::Polygon& clip)
+{
+	subj.push_back (cbop::Contour ());
+	subj.back ().add (cbop::Point_2 (0, -1));
+	subj.back ().add (cbop::Point_2 (2 * n, -1));
+	subj.back ().add (cbop::Point_2 (2 * n, 0));
+	subj.back ().add (cbop::Point_2 (0, 0));
+	for (int i = 0; i < n; i++) {
+		clip.push_back (cbop::Contour ());
+		clip.back ().add (cbop::Point_2 (2 * i, 0));
+		clip.back ().add (cbop::Point_2 (2 * i + 1, 0));
+		clip.back ().add (cbop::Point_2 (2 * i + 1, 1));
+		clip.back ().add (cbop::Point_2 (2 * i, 1));
+	}
+}
+
+/** @brief Run the four operations on inputs with many collinear overlapping edges
+ *
+ * For the comb the connection of the result edges is also timed when the sweep hands the points over in
+ * reverse order, the worst case for the reordering of the events in BooleanOpImp::connect. The comb has
+ * small integer coordinates, so the order of its events does not depend on rounding errors
+ */
+int adversarialBench (int argc, char* argv[], const std::string& paramError)
+{
+	if (argc != 4)
+		fatalError (paramError, 2);
+	int n = atoi (argv[2]);
+	int repetitions = atoi (argv[3]);
+	if (n < 1 || repetitions < 1)
+		fatalError (paramError, 2);
+	const char* names[2] = { "fan", "comb" };
+	const std::string ope = "IUDX";
+	const double inf = std::numeric_limits<double>::infinity ();
+	cbop::BooleanOp engine;
+	cbop::BooleanOpImp imp;
+	for (int input = 0; input < 2; input++) {
+		cbop::Polygon subj, clip, result;
+		if (input == 0)
+			fan (n, subj, clip);
+		else
+			comb (n, subj, clip);
+		std::cout << names[input] << " (" << subj.nvertices () + clip.nvertices () << " vertices):";
+		cbop::BooleanOpStatus status = cbop::SUCCESS;
+		for (int op = 0; op < 4; op++) {
+			double start = wallTime ();
+			for (int r = 0; r < repetitions; r++) {
+				result.clear ();
+				status = engine.compute (subj, clip, result, static_cast<cbop::BooleanOpType> (op));
+			}
+			std::cout << ' ' << ope[op] << ": " << (wallTime () - start) / repetitions * 1000.0 << " ms" << (status != cbop::SUCCESS ? " (failed)" : "");
+		}
+		if (input == 1 && status == cbop::SUCCESS) {
+			double total = 0.0;
+			for (int r = 0; r < repetitions; r++) {
+				imp.sweepSlab (subj, clip, cbop::XOR, -inf, inf);
+				// reverse the order of the points, keeping the order of the events of every point
+				std::vector<cbop::SweepEvent*>& sorted = imp.events ();
+				std::vector<cbop::SweepEvent*> events;
+				events.reserve (sorted.size ());
+				for (size_t end = sorted.size (), begin; end > 0; end = begin) {
+					for (begin = end - 1; begin > 0 && sorted[begin - 1]->point == sorted[end - 1]->point; begin--)
+						;
+					events.insert (events.end (), sorted.begin () + begin, sorted.begin () + end);
+				}
+				result.clear ();
+				double start = wallTime ();
+				imp.connect (events, result);
+				total += wallTime () - start;
+			}
+			std::cout << ", connecting the reversed events of X: " << total / repetitions * 1000.0 << " ms";
+		}
+		std::cout << "\n";
+	}
+	return 0;
+}
+
+/** Are the polygons equal, coordinates compared bit by bit? */
+bool samePolygon (const cbop::Polygon& p, const cbop::Polygon& q)
+{
+	if (p.ncontours () != q.ncontours ())
+		return false;
+	for (unsigned int i = 0; i < p.ncontours (); i++) {
+		if (p[i].nvertices () != q[i].nvertices () || p[i].nholes () != q[i].nholes () || p[i].external () != q[i].external ())
+			return false;
+		if (p[i].nvertices () > 0 && memcmp (&*p[i].begin (), &*q[i].begin (), p[i].nvertices () * sizeof (cbop::Point_2)) != 0)
+			return false;
+		for (unsigned int j = 0; j < p[i].nholes (); j++)
+			if (p[i].hole (j) != q[i].hole (j))
+				return false;
+	}
+	return true;
+}
+
+/** Compute a single operation serially and with BatchBooleanOp::computeInSlabs */
+int slabBench (int argc, char* argv[], const std::string& paramError)
+{
+	const std::string ope = "IUDX";
+	if (argc != 7 || ope.find (argv[2][0]) == std::string::npos)
+		fatalError (paramError, 2);
+	cbop::BooleanOpType op = static_cast<cbop::BooleanOpType> (ope.find (argv[2][0]));
+	int nthreads = atoi (argv[3]);
+	int repetitions = atoi (argv[4]);
+	if (nthreads < 0 || repetitions < 1)
+		fatalError (paramError, 2);
+	cbop::Polygon subj, clip;
+	if (! subj.open (argv[5]))
+		fatalError (std::string (argv[5]) + " does not exist or has a bad format\n", 3);
+	if (! clip.open (argv[6]))
+		fatalError (std::string (argv[6]) + " does not exist or has a bad format\n", 3);
+
+	cbop::BooleanOp engine;
+	cbop::Polygon serialResult, slabResult;
+	double start = wallTime ();
+	for (int r = 0; r < repetitions; r++) {
+		serialResult.clear ();
+		engine.compute (subj, clip, serialResult, op);
+	}
+	double serial = (wallTime () - start) / repetitions;
+	cbop::BatchBooleanOp batch (nthreads);
+	cbop::BooleanOpStatus status = cbop::SUCCESS;
+	start = wallTime ();
+	for (int r = 0; r < repetitions; r++) {
+		slabResult.clear ();
+		status = batch.computeInSlabs (subj, clip, slabResult, op);
+	}
+	double parallel = (wallTime () - start) / repetitions;
+	const cbop::SlabCounters& counters = batch.slabCounters ();
+	std::cout << batch.nthreads () << " threads" << (status != cbop::SUCCESS ? " (failed)" : "") << ", " << counters.slabs << " slabs, "
+	          << counters.droppedBoundaries << " boundaries dropped" << (counters.serial ? ", computed serially" : "") << "\n";
+	std::cout << "serial: " << serial * 1000.0 << " ms (" << serialResult.nvertices () << " vertices), slabs: "
+	          << parallel * 1000.0 << " ms (" << slabResult.nvertices () << " vertices), speedup: " << serial / parallel << "\n";
+	return 0;
+}
+
+/** @brief Compute the four operations between every ordered pair of different polygons with BooleanOpImp and with
+ * BatchBooleanOp::computeInSlabs, for 2 to threads slabs. The outcomes and the results must be the same, bit by bit
+ */
+int slabCheck (int argc, char* argv[], const std::string& paramError)
+{
+	if (argc < 5)
+		fatalError (paramError, 2);
+	int nthreads = atoi (argv[2]);
+	if (nthreads < 2)
+		fatalError (paramError, 2);
+	std::vector<cbop::Polygon> polygons (argc - 3);
+	for (int i = 3; i < argc; i++)
+		if (! polygons[i - 3].open (argv[i]))
+			fatalError (std::string (argv[i]) + " does not exist or has a bad format\n", 3);
+	const std::string ope = "IUDX";
+	cbop::BooleanOpImp imp;
+	unsigned int operations = 0, differ = 0, split = 0, serial = 0;
+	for (int t = 2; t <= nthreads; t++) {
+		cbop::BatchBooleanOp batch (t);
+		for (unsigned int i = 0; i < polygons.size (); i++)
+			for (unsigned int j = 0; j < polygons.size (); j++)
+				for (int op = 0; op < 4 && i != j; op++) {
+					cbop::Polygon serialResult, slabResult;
+					imp.run (polygons[i], polygons[j], serialResult, static_cast<cbop::BooleanOpType> (op));
+					cbop::BooleanOpStatus status = batch.computeInSlabs (polygons[i], polygons[j], slabResult, static_cast<cbop::BooleanOpType> (op));
+					operations++;
+					split += batch.slabCounters ().slabs > 0 && !batch.slabCounters ().serial;
+					serial += batch.slabCounters ().serial;
+					if (status != imp.status () || (status == cbop::SUCCESS && ! samePolygon (serialResult, slabResult))) {
+						differ++;
+						std::cout << argv[i + 3] << ' ' << ope[op] << ' ' << argv[j + 3] << ", " << t << " threads: different results\n";
+					}
+				}
+	}
+	std::cout << operations << " operations, " << differ << " different, " << split << " split into slabs, "
+	          << serial << " computed serially after sweeping the slabs\n";
+	return differ != 0;
+}
+
+/** An operation between two contours that was once computed wrongly, with the sizes of its correct results */
+struct RegressionCase {
+	const char* description;
+	std::vector<double> subject;  // x and y of the vertices
+	std::vector<double> clipping;
+	unsigned int contours[4];     // contours and vertices of the results of I, U, D and X
+	unsigned int vertices[4];
+};
+
+/** Contour with the vertices (coordinates[0], coordinates[1]), (coordinates[2], coordinates[3])... */
+cbop::Polygon contourPolygon (const std::vector<double>& coordinates)
+{
+	cbop::Polygon p;
+	cbop::Contour& c = p.emplace_back ();
+	for (size_t i = 0; i + 1 < coordinates.size (); i += 2)
+		c.add (cbop::Point_2 (coordinates[i], coordinates[i + 1]));
+	return p;
+}
+
+/** Compute the four operations of the regression cases and check the numbers of contours and vertices of the results */
+int regressionCheck (int argc, char* argv[], const std::string& paramError)
+{
+	if (argc != 2)
+		fatalError (paramError, 2);
+	const RegressionCase cases[] = {
+		{ "edge 1e-9 above the top edge of the subject, disjoint bounding boxes taken as overlapping edges by findIntersection",
+		  { 0, 0, 1, 0, 1, 1, 0, 1 }, { 0.2, 1.000000001, 0.8, 1.000000001, 1.5, 0.5, 2, 0.5, 2, 2, 0.2, 2 },
+		  { 1, 1, 1, 1 }, { 3, 9, 6, 12 } }
+	};
+	const std::string ope = "IUDX";
+	cbop::BooleanOp engine;
+	unsigned int failed = 0;
+	for (size_t i = 0; i < sizeof (cases) / sizeof (cases[0]); i++) {
+		const cbop::Polygon subj = contourPolygon (cases[i].subject);
+		const cbop::Polygon clip = contourPolygon (cases[i].clipping);
+		for (int op = 0; op < 4; op++) {
+			cbop::Polygon result;
+			engine.compute (subj, clip, result, static_cast<cbop::BooleanOpType> (op));
+			if (result.ncontours () != cases[i].contours[op] || result.nvertices () != cases[i].vertices[op]) {
+				failed++;
+				std::cout << cases[i].description << ", " << ope[op] << ": " << result.ncontours () << " contours and "
+				          << result.nvertices () << " vertices, expected " << cases[i].contours[op] << " and " << cases[i].vertices[op] << "\n";
+			}
+		}
+	}
+	std::cout << sizeof (cases) / sizeof (cases[0]) << " cases, " << failed << " wrong results\n";
+	return failed != 0;
+}
+
+/** Compute a single operation with double coordinates and on an integer grid */
+int gridBench (int argc, char* argv[], const std::string& paramError)
+{
+	const std::string ope = "IUDX";
+	if (argc != 7 || ope.find (argv[3][0]) == std::string::npos)
+		fatalError (paramError, 2);
+	double unit = atof (argv[2]);
+	cbop::BooleanOpType op = static_cast<cbop::BooleanOpType> (ope.find (argv[3][0]));
+	int repetitions = atoi (argv[4]);
+	if (!(unit > 0.0) || repetitions < 1)
+		fatalError (paramError, 2);
+	cbop::Polygon subj, clip;
+	if (! subj.open (argv[5]))
+		fatalError (std::string (argv[5]) + " does not exist or has a bad format\n", 3);
+	if (! clip.open (argv[6]))
+		fatalError (std::string (argv[6]) + " does not exist or has a bad format\n", 3);
+
+	cbop::BooleanOp engine;
+	cbop::Polygon doubleResult, gridResult;
+	cbop::BooleanOpStatus status = cbop::SUCCESS;
+	double start = wallTime ();
+	for (int r = 0; r < repetitions; r++) {
+		doubleResult.clear ();
+		engine.compute (subj, clip, doubleResult, op);
+	}
+	double doubleTime = (wallTime () - start) / repetitions;
+	start = wallTime ();
+	for (int r = 0; r < repetitions; r++) {
+		gridResult.clear ();
+		status = engine.computeOnGrid (subj, clip, gridResult, op, unit);
+	}
+	double gridTime = (wallTime () - start) / repetitions;
+	std::cout << "double: " << doubleTime * 1000.0 << " ms (" << doubleResult.nvertices () << " vertices), grid: "
+	          << gridTime * 1000.0 << " ms (" << gridResult.nvertices () << " vertices)" << (status != cbop::SUCCESS ? " (failed)" : "") << "\n";
+	return 0;
+}
+
+/** @brief Insert edges into the status line of the sweep in random order, and remove them
+ *
+ * The edges do not cross: the i-th edge goes from x in [0, 1] to x in [2, 3], and its endpoints are at a
+ * distance of less than 0.5 from y = i. Their left endpoints differ, as most of the edges compared in a sweep
+ */
+int statusLineBench (int argc, char* argv[], const std::string& paramError)
+{
+	if (argc != 4)
+		fatalError (paramError, 2);
+	int n = atoi (argv[2]);
+	int repetitions = atoi (argv[3]);
+	if (n < 1 || repetitions < 1)
+		fatalError (paramError, 2);
+	std::vector<cbop::SweepEvent> events (2 * n);
+	std::vector<cbop::SweepEvent*> order (n);
+	srand (1);
+	for (int i = 0; i < n; i++) {
+		cbop::SweepEvent* le = &events[2 * i];
+		cbop::SweepEvent* re = &events[2 * i + 1];
+		*le = cbop::SweepEvent (true, cbop::Point_2 (rand () / (RAND_MAX + 1.0), i + rand () / (RAND_MAX + 1.0) - 0.5), re, cbop::SUBJECT);
+		*re = cbop::SweepEvent (false, cbop::Point_2 (2 + rand () / (RAND_MAX + 1.0), i + rand () / (RAND_MAX + 1.0) - 0.5), le, cbop::SUBJECT);
+		le->setLine ();
+		order[i] = le;
+	}
+	for (int i = n - 1; i > 0; i--)
+		std::swap (order[i], order[rand () % (i + 1)]);
+	cbop::SweepLine sl;
+	double insertion = 0.0, removal = 0.0;
+	for (int r = 0; r < repetitions; r++) {
+		double start = wallTime ();
+		for (int i = 0; i < n; i++)
+			sl.insert (order[i]);
+		double middle = wallTime ();
+		for (int i = 0; i < n; i++)
+			sl.erase (order[i]);
+		removal += wallTime () - middle;
+		insertion += middle - start;
+	}
+	std::cout << n << " edges, insertion: " << insertion / repetitions / n * 1e9 << " ns per edge, removal: "
+	          << removal / repetitions / n * 1e9 << " ns per edge\n";
+	return 0;
+}
+
+/** Twice the signed area of p */
+double polygonArea (const cbop::Polygon& p)
+{
+	double area = 0.0;
+	for (unsigned int c = 0; c < p.ncontours (); c++)
+		for (unsigned int j = 0; j < p[c].nvertices (); j++)
+			area += p[c].segment (j).source ().x () * p[c].segment (j).target ().y () - p[c].segment (j).target ().x () * p[c].segment (j).source ().y ();
+	return area;
+}
+
+/** A convex polygon with n vertices at random angles on the circle of center (x, y) and radius r */
+cbop::Polygon convexPolygon (int n, double x, double y, double r)
+{
+	const double PI = 3.14159265358979323846;
+	std::vector<double> angles (n);
+	for (int i = 0; i < n; i++)
+		angles[i] = 2 * PI * rand () / (RAND_MAX + 1.0);
+	std::sort (angles.begin (), angles.end ());
+	cbop::Polygon p;
+	p.push_back (cbop::Contour ());
+	for (int i = 0; i < n; i++)
+		p.back ().add (cbop::Point_2 (x + r * cos (angles[i]), y + r * sin (angles[i])));
+	return p;
+}
+
+/** @brief Intersect pairs of overlapping random convex polygons with the sweep and with convexIntersection
+ *
+ * The results are compared: the number of vertices must be the same and the areas must agree up to rounding
+ */
+int convexBench (int argc, char* argv[], const std::string& paramError)
+{
+	if (argc != 4)
+		fatalError (paramError, 2);
+	int n = atoi (argv[2]);
+	int repetitions = atoi (argv[3]);
+	if (n < 3 || repetitions < 1)
+		fatalError (paramError, 2);
+	srand (1);
+	const int pairs = 100;
+	std::vector<cbop::Polygon> subj, clip;
+	for (int i = 0; i < pairs; i++) {
+		subj.push_back (convexPolygon (n, 0.0, 0.0, 1.0));
+		clip.push_back (convexPolygon (n, rand () / (RAND_MAX + 1.0), rand () / (RAND_MAX + 1.0), 1.0));
+		if (subj.back ()[0].convexity () == 0 || clip.back ()[0].convexity () == 0)
+			fatalError ("The random polygons are not strictly convex, use a smaller size\n", 4);
+	}
+	std::vector<cbop::Polygon> sweepResult (pairs), convexResult (pairs);
+	cbop::BooleanOpImp imp;
+	double start = wallTime ();
+	for (int r = 0; r < repetitions; r++)
+		for (int i = 0; i < pairs; i++) {
+			sweepResult[i].clear ();
+			imp.run (subj[i], clip[i], sweepResult[i], cbop::INTERSECTION);
+		}
+	double sweep = (wallTime () - start) / repetitions / pairs;
+	int fallbacks = 0;
+	start = wallTime ();
+	for (int r = 0; r < repetitions; r++)
+		for (int i = 0; i < pairs; i++) {
+			convexResult[i].clear ();
+			fallbacks += !cbop::convexIntersection (subj[i], clip[i], convexResult[i]);
+		}
+	double convex = (wallTime () - start) / repetitions / pairs;
+	int differ = 0;
+	for (int i = 0; i < pairs; i++) {
+		double area[2] = { polygonArea (sweepResult[i]), polygonArea (convexResult[i]) };
+		if (sweepResult[i].nvertices () != convexResult[i].nvertices () || std::fabs (area[0] - area[1]) > 1e-12 * std::fabs (area[0]))
+			differ++;
+	}
+	std::cout << pairs << " pairs of " << n << "-gons, sweep: " << sweep * 1e6 << " us, convex: " << convex * 1e6 << " us, speedup: "
+	          << sweep / convex << ", " << fallbacks << " fell back, " << differ << " different results\n";
+	return differ != 0;
+}
+
+/** A star-shaped contour with n vertices at random distances between r / 2 and r from (x, y) */
+cbop::Contour starContour (int n, double x, double y, double r)
+{
+	const double PI = 3.14159265358979323846;
+	cbop::Contour c;
+	for (int i = 0; i < n; i++) {
+		double d = r * (0.5 + 0.5 * rand () / (RAND_MAX + 1.0));
+		c.add (cbop::Point_2 (x + d * cos (2 * PI * i / n), y + d * sin (2 * PI * i / n)));
+	}
+	return c;
+}
+
+/** @brief Clip a star-shaped polygon with holes to random axis-aligned windows with the sweep and with clipToRectangle
+ *
+ * The results are compared: the number of contours and vertices must be the same and the areas must agree up to rounding.
+ * The windows for which the sweep fails (its tolerance merges the vertices of very short edges) are not compared
+ */
+int rectangleBench (int argc, char* argv[], const std::string& paramError)
+{
+	if (argc != 4)
+		fatalError (paramError, 2);
+	int n = atoi (argv[2]);
+	int repetitions = atoi (argv[3]);
+	if (n < 16 || repetitions < 1)
+		fatalError (paramError, 2);
+	srand (1);
+	cbop::Polygon subj;
+	subj.push_back (starContour (n, 0.0, 0.0, 1.0));
+	for (int i = 0; i < 4; i++) { // holes with n / 8 vertices around (+-0.2, +-0.2)
+		subj.push_back (starContour (n / 8, (i & 1) ? 0.2 : -0.2, (i & 2) ? 0.2 : -0.2, 0.15));
+		subj.back ().changeOrientation ();
+	}
+	const int windows = 100;
+	std::vector<cbop::Polygon> clip (windows);
+	for (int i = 0; i < windows; i++) {
+		double x = 1.6 * rand () / (RAND_MAX + 1.0) - 1.0, y = 1.6 * rand () / (RAND_MAX + 1.0) - 1.0;
+		double w = 0.1 + 0.5 * rand () / (RAND_MAX + 1.0), h = 0.1 + 0.5 * rand () / (RAND_MAX + 1.0);
+		clip[i].push_back (cbop::Contour ());
+		clip[i].back ().add (cbop::Point_2 (x, y));
+		clip[i].back ().add (cbop::Point_2 (x + w, y));
+		clip[i].back ().add (cbop::Point_2 (x + w, y + h));
+		clip[i].back ().add (cbop::Point_2 (x, y + h));
+	}
+	std::vector<cbop::Polygon> sweepResult (windows), rectangleResult (windows);
+	std::vector<cbop::BooleanOpStatus> status (windows);
+	cbop::BooleanOpImp imp;
+	double start = wallTime ();
+	for (int r = 0; r < repetitions; r++)
+		for (int i = 0; i < windows; i++) {
+			sweepResult[i].clear ();
+			imp.run (subj, clip[i], sweepResult[i], cbop::INTERSECTION);
+			status[i] = imp.status ();
+		}
+	double sweep = (wallTime () - start) / repetitions / windows;
+	cbop::BooleanOp engine;
+	start = wallTime ();
+	for (int r = 0; r < repetitions; r++)
+		for (int i = 0; i < windows; i++) {
+			rectangleResult[i].clear ();
+			engine.clipToRectangle (subj, clip[i].bbox (), rectangleResult[i]);
+		}
+	double rectangle = (wallTime () - start) / repetitions / windows;
+	int fallbacks = 0, differ = 0, failed = 0;
+	for (int i = 0; i < windows; i++) {
+		cbop::Polygon clipped;
+		fallbacks += !cbop::rectangleIntersection (subj, clip[i].bbox (), clipped);
+		if (status[i] != cbop::SUCCESS) {
+			failed++;
+			continue;
+		}
+		double area[2] = { polygonArea (sweepResult[i]), polygonArea (rectangleResult[i]) };
+		if (sweepResult[i].ncontours () != rectangleResult[i].ncontours () || sweepResult[i].nvertices () != rectangleResult[i].nvertices () ||
+		    std::fabs (area[0] - area[1]) > 1e-12 * std::fabs (area[0]))
+			differ++;
+	}
+	std::cout << windows << " windows on a " << n << "-gon with 4 holes, sweep: " << sweep * 1e6 << " us, rectangle: " << rectangle * 1e6
+	          << " us, speedup: " << sweep / rectangle << ", " << fallbacks << " fell back, " << failed << " failed in the sweep, "
+	          << differ << " different results\n";
+	return differ != 0;
+}
+
+/** Read the polygon files repetitions times and report the time per file and the speed of the parser. The binary files are mapped */
+int loadBench (int argc, char* argv[], const std::string& paramError)
+{
+	if (argc < 4)
+		fatalError (paramError, 2);
+	int repetitions = atoi (argv[2]);
+	if (repetitions < 1)
+		fatalError (paramError, 2);
+	double bytes = 0.0;
+	for (int i = 3; i < argc; i++) {
+		std::ifstream f (argv[i], std::ios::binary | std::ios::ate);
+		if (!f)
+			fatalError (std::string (argv[i]) + " does not exist\n", 3);
+		bytes += f.tellg ();
+	}
+	std::vector<bool> binary (argc);
+	for (int i = 3; i < argc; i++)
+		binary[i] = cbop::isBinaryPolygon (argv[i]);
+	unsigned int vertices = 0;
+	double start = wallTime ();
+	for (int r = 0; r < repetitions; r++)
+		for (int i = 3; i < argc; i++) {
+			if (binary[i]) {
+				cbop::MappedPolygon p;
+				if (! p.open (argv[i]))
+					fatalError (std::string (argv[i]) + " has a bad format\n", 3);
+				vertices += p.view ().nvertices ();
+				continue;
+			}
+			cbop::Polygon p;
+			if (! p.open (argv[i]))
+				fatalError (std::string (argv[i]) + " has a bad format\n", 3);
+			vertices += p.nvertices ();
+		}
+	double t = (wallTime () - start) / repetitions;
+	std::cout << argc - 3 << " files, " << vertices / repetitions << " vertices, " << t / (argc - 3) * 1e6 << " us per file, "
+	          << bytes / t / 1e6 << " MB/s\n";
+	return 0;
+}
+
+/** @brief Write the polygon files to memory repetitions times with operator<< (17 digits) and with PolygonWriter
+ *
+ * The texts written by PolygonWriter are read back, and the polygons must be the same
+ */
+int writeBench (int argc, char* argv[], const std::string& paramError)
+{
+	if (argc < 4)
+		fatalError (paramError, 2);
+	int repetitions = atoi (argv[2]);
+	if (repetitions < 1)
+		fatalError (paramError, 2);
+	std::vector<cbop::Polygon> polygons (argc - 3);
+	for (int i = 3; i < argc; i++)
+		if (! polygons[i - 3].open (argv[i]))
+			fatalError (std::string (argv[i]) + " does not exist or has a bad format\n", 3);
+	double streamBytes = 0.0;
+	double start = wallTime ();
+	for (int r = 0; r < repetitions; r++)
+		for (size_t i = 0; i < polygons.size (); i++) {
+			std::ostringstream o;
+			o.precision (17);
+			o << polygons[i];
+			streamBytes += o.str ().size ();
+		}
+	double stream = (wallTime () - start) / repetitions;
+	std::vector<std::string> texts (polygons.size ());
+	start = wallTime ();
+	for (int r = 0; r < repetitions; r++)
+		for (size_t i = 0; i < polygons.size (); i++) {
+			texts[i].clear ();
+			cbop::PolygonWriter writer (texts[i]);
+			writer.write (polygons[i]);
+		}
+	double writer = (wallTime () - start) / repetitions;
+	double writerBytes = 0.0;
+	int differ = 0;
+	for (size_t i = 0; i < polygons.size (); i++) {
+		writerBytes += texts[i].size ();
+		cbop::Polygon p;
+		if (! p.parse (texts[i].data (), texts[i].data () + texts[i].size ()) || ! samePolygon (p, polygons[i]))
+			differ++;
+	}
+	std::cout << polygons.size () << " polygons, operator<<: " << streamBytes / repetitions / stream / 1e6 << " MB/s, PolygonWriter: "
+	          << writerBytes / writer / 1e6 << " MB/s (" << writerBytes / (streamBytes / repetitions) * 100 << "% of the size), speedup: "
+	          << stream / writer << ", " << differ << " not read back exactly\n";
+	return differ != 0;
+}
+
+/** @brief Polygons made up of n building footprints: n small squares, laid out on a grid and shifted by offset */
+cbop::Polygon footprints (int n, double offset)
+{
+	cbop::Polygon p;
+	int side = int (std::ceil (std::sqrt (double (n))));
+	for (int i = 0; i < n; i++) {
+		double x = (i % side) * 2.0 + offset, y = (i / side) * 2.0 + offset;
+		cbop::Contour c;
+		c.add (cbop::Point_2 (x, y));
+		c.add (cbop::Point_2 (x + 1.0, y));
+		c.add (cbop::Point_2 (x + 1.0, y + 1.0));
+		c.add (cbop::Point_2 (x, y + 1.0));
+		p.push_back (c);
+	}
+	return p;
+}
+
+/** @brief Read the text of two polygons of many small contours into Polygon and FlatPolygon, and intersect them
+ *
+ * The results of the operation on the Polygons and on the views of the FlatPolygons must be the same
+ */
+int footprintBench (int argc, char* argv[], const std::string& paramError)
+{
+	if (argc < 4)
+		fatalError (paramError, 2);
+	int n = atoi (argv[2]);
+	int repetitions = atoi (argv[3]);
+	if (n < 1 || repetitions < 1)
+		fatalError (paramError, 2);
+	std::string text[2];
+	for (int i = 0; i < 2; i++) {
+		cbop::PolygonWriter writer (text[i]);
+		writer.write (footprints (n, i * 0.5));
+	}
+	cbop::Polygon polygon[2];
+	cbop::FlatPolygon flat[2];
+	double start = wallTime ();
+	for (int r = 0; r < repetitions; r++)
+		for (int i = 0; i < 2; i++) {
+			polygon[i] = cbop::Polygon ();
+			polygon[i].parse (text[i].data (), text[i].data () + text[i].size ());
+		}
+	double polygonParse = (wallTime () - start) / repetitions / 2;
+	start = wallTime ();
+	for (int r = 0; r < repetitions; r++)
+		for (int i = 0; i < 2; i++) {
+			flat[i].clear ();
+			flat[i].parse (text[i].data (), text[i].data () + text[i].size ());
+		}
+	double flatParse = (wallTime () - start) / repetitions / 2;
+	cbop::BooleanOpImp engine;
+	cbop::Polygon polygonResult, flatResult;
+	start = wallTime ();
+	for (int r = 0; r < repetitions; r++) {
+		polygonResult = cbop::Polygon ();
+		engine.run (polygon[0], polygon[1], polygonResult, cbop::INTERSECTION);
+	}
+	double polygonOperation = (wallTime () - start) / repetitions;
+	start = wallTime ();
+	for (int r = 0; r < repetitions; r++) {
+		flatResult = cbop::Polygon ();
+		engine.run (flat[0].view (), flat[1].view (), flatResult, cbop::INTERSECTION);
+	}
+	double flatOperation = (wallTime () - start) / repetitions;
+	bool differ = ! samePolygon (polygonResult, flatResult);
+	std::cout << n << " contours of 4 vertices, parse Polygon: " << polygonParse * 1e3 << " ms, FlatPolygon: " << flatParse * 1e3
+	          << " ms, speedup: " << polygonParse / flatParse << "; intersection Polygon: " << polygonOperation * 1e3 << " ms, FlatPolygon: "
+	          << flatOperation * 1e3 << " ms, speedup: " << polygonOperation / flatOperation << (differ ? ", different results" : "") << '\n';
+	return differ;
+}
+
+int main (int argc, char* argv[])
+{
+	std::string paramError = "Syntax: " + std::string (argv[0]) + " subject clipping [I|U|D|X] [repetitions]\n";
+	paramError += "\tRuns the Boolean operation repetitions times (default 10) and reports the time per operation\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -b I|U|D|X threads repetitions polygon polygon...\n";
+	paramError += "\tComputes the operation between every ordered pair of polygons, serially and as a batch (threads 0: one per core)\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -p I|U|D|X repetitions polygon polygon...\n";
+	paramError += "\tReports the median and 90th percentile of the time of the operation between every ordered pair of polygons\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -u threads copies polygon...\n";
+	paramError += "\tUnites copies of the polygons laid out on a grid, sequentially and with computeUnion\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -s I|U|D|X threads repetitions subject clipping\n";
+	paramError += "\tRuns the Boolean operation serially and split into vertical slabs, one per thread\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -e threads polygon polygon...\n";
+	paramError += "\tChecks that the operations between every ordered pair of polygons split into 2 to threads slabs are exact\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -k\n";
+	paramError += "\tChecks the results of operations that were once computed wrongly\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -a size repetitions\n";
+	paramError += "\tRuns the four operations on generated inputs with many collinear overlapping edges\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -g unit I|U|D|X repetitions subject clipping\n";
+	paramError += "\tRuns the Boolean operation with double coordinates and on the integer grid of spacing unit\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -l size repetitions\n";
+	paramError += "\tInserts size edges into the status line of the sweep in random order and removes them\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -c size repetitions\n";
+	paramError += "\tIntersects pairs of random convex polygons with size vertices with the sweep and in linear time\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -r size repetitions\n";
+	paramError += "\tClips a polygon with size vertices and holes to random rectangles with the sweep and in linear time\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -t repetitions polygon...\n";
+	paramError += "\tReads the polygon files (text or binary) and reports the time per file and the speed of the parser\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -w repetitions polygon...\n";
+	paramError += "\tWrites the polygons to memory with operator<< and with PolygonWriter, and reads them back\n";
+	paramError += "Syntax: " + std::string (argv[0]) + " -f contours repetitions\n";
+	paramError += "\tReads and intersects polygons of many small contours stored as Polygon and as FlatPolygon\n";
+	if (argc > 1 && std::string (argv[1]) == "-b")
+		return batchBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-p")
+		return latencyBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-u")
+		return unionBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-a")
+		return adversarialBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-s")
+		return slabBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-e")
+		return slabCheck (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-k")
+		return regressionCheck (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-g")
+		return gridBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-l")
+		return statusLineBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-c")
+		return convexBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-r")
+		return rectangleBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-t")
+		return loadBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-w")
+		return writeBench (argc, argv, paramError);
+	if (argc > 1 && std::string (argv[1]) == "-f")
+		return footprintBench (argc, argv, paramError);
+	if (argc < 3)
+		fatalError (paramError, 1);
+	const std::string ope = "IUDX";
+	if (argc > 3 && ope.find (argv[3][0]) == std::string::npos)
+		fatalError (paramError, 2);
+	int repetitions = (argc > 4) ? atoi (argv[4]) : 10;
+	if (repetitions < 1)
+		fatalError (paramError, 2);
+
+	cbop::Polygon subj, clip;
+	if (! subj.open (argv[1]))
+		fatalError (std::string (argv[1]) + " does not exist or has a bad format\n", 3);
+	if (! clip.open (argv[2]))
+		fatalError (std::string (argv[2]) + " does not exist or has a bad format\n", 3);
+	cbop::BooleanOpType op = cbop::INTERSECTION;
+	if (argc > 3)
+		op = static_cast<cbop::BooleanOpType> (ope.find (argv[3][0]));
+
+	// cbop::compute builds a new BooleanOpImp on every call but for small operations, the engine reuses its memory
+	cbop::BooleanOp engine;
+	for (int useEngine = 0; useEngine < 2; useEngine++) {
+		double best = 0.0, total = 0.0;
+		unsigned int nvertices = 0;
+		for (int i = 0; i < repetitions; i++) {
+			cbop::Polygon result;
+			clock_t start = clock ();
+			if (useEngine)
+				engine.compute (subj, clip, result, op);
+			else
+				cbop::compute (subj, clip, result, op);
+			double t = (clock () - start) / double (CLOCKS_PER_SEC);
+			if (i == 0 || t < best)
+				best = t;
+			total += t;
+			nvertices = result.nvertices ();
+		}
+		if (!useEngine)
+			std::cout << subj.nvertices () << " + " << clip.nvertices () << " vertices -> " << nvertices << " vertices\n";
+		std::cout << (useEngine ? "BooleanOp: " : "compute:   ") << "best: " << best * 1000.0 << " ms, mean: "
+		          << total / repetitions * 1000.0 << " ms (" << repetitions << " runs)\n";
+	}
+	std::cout << engine.counters ().neighbourPairs << " pairs of neighbour edges, " << engine.counters ().intersectionTests
+	          << " intersection tests\n";
+	return 0;
+}
@@ -0,0 +1,129 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include "binarypolygon.h"
+
+using namespace cbop;
+
+static_assert (sizeof (BinaryHeader) == 64, "unexpected padding in BinaryHeader");
+static_assert (sizeof (ContourRecord) == 48, "unexpected padding in ContourRecord");
+static_assert (sizeof (Point_2) == 2 * sizeof (double), "the points of a binary file cannot be used as Point_2");
+
+namespace { // start of anonymous namespace
+
+const char magicNumber[4] = { 'C', 'B', 'O', 'P' };
+const uint32_t byteOrderMark = 0x01020304;
+
+/** Offset of the hole array in the file */
+uint64_t holesOffset (const BinaryHeader& h)
+{
+	return sizeof (BinaryHeader) + (uint64_t (h.ncontours) + 1) * sizeof (ContourRecord);
+}
+
+/** Offset of the point array in the file */
+uint64_t pointsOffset (const BinaryHeader& h)
+{
+	return holesOffset (h) + (uint64_t (h.nholes) * sizeof (uint32_t) + 7) / 8 * 8;
+}
+
+uint64_t fileSize (const BinaryHeader& h)
+{
+	return pointsOffset (h) + uint64_t (h.nvertices) * sizeof (Point_2);
+}
+
+} // end of anonymous namespace
+
+bool cbop::isBinaryPolygon (const std::string& filename)
+{
+	std::ifstream f (filename.c_str (), std::ios::binary);
+	char magic[4];
+	return f.read (magic, 4) && memcmp (magic, magicNumber, 4) == 0;
+}
+
+bool cbop::writeBinary (const PolygonView& p, const std::string& filename)
+{
+	BinaryHeader h;
+	memset (&h, 0, sizeof (h));
+	memcpy (h.magic, magicNumber, 4);
+	h.version = binaryVersion;
+	h.byteOrder = byteOrderMark;
+	h.ncontours = p.ncontours ();
+	h.nvertices = p.nvertices ();
+	h.nholes = p.nholes ();
+	Bbox_2 bb = p.bbox ();
+	h.xmin = bb.xmin ();
+	h.ymin = bb.ymin ();
+	h.xmax = bb.xmax ();
+	h.ymax = bb.ymax ();
+	// the tables of the file start at the first vertex and the first hole
+	std::vector<ContourRecord> records (p.ncontours () + 1);
+	const ContourRecord* first = p.contourRecords ();
+	for (unsigned int i = 0; i <= p.ncontours () && first; i++) {
+		records[i] = first[i];
+		records[i].firstVertex -= first[0].firstVertex;
+		records[i].firstHole -= first[0].firstHole;
+		records[i].reserved = 0;
+	}
+	std::vector<uint32_t> holes ((pointsOffset (h) - holesOffset (h)) / sizeof (uint32_t), 0); // with the padding
+	if (first)
+		std::copy (p.holeArray () + first[0].firstHole, p.holeArray () + first[0].firstHole + h.nholes, holes.begin ());
+	std::ofstream f (filename.c_str (), std::ios::binary);
+	if (!f)
+		return false;
+	f.write (reinterpret_cast<const char*> (&h), sizeof (h));
+	f.write (reinterpret_cast<const char*> (&records[0]), records.size () * sizeof (ContourRecord));
+	if (!holes.empty ())
+		f.write (reinterpret_cast<const char*> (&holes[0]), holes.size () * sizeof (uint32_t));
+	if (h.nvertices > 0)
+		f.write (reinterpret_cast<const char*> (p.pointArray () + first[0].firstVertex), h.nvertices * sizeof (Point_2));
+	return bool (f.flush ());
+}
+
+bool MappedPolygon::open (const std::string& filename)
+{
+	close ();
+	file.reset (new FileText (filename)); // its memory is aligned for doubles, mapped or allocated
+	const char* base = file->begin ();
+	size_t size = file->end () - file->begin ();
+	if (!file->good () || size < sizeof (BinaryHeader)) {
+		close ();
+		return false;
+	}
+	const BinaryHeader& h = *reinterpret_cast<const BinaryHeader*> (base);
+	if (memcmp (h.magic, magicNumber, 4) != 0 || h.version != binaryVersion ||
+	    h.byteOrder != byteOrderMark || fileSize (h) != size) {
+		close ();
+		return false;
+	}
+	const ContourRecord* records = reinterpret_cast<const ContourRecord*> (base + sizeof (BinaryHeader));
+	const uint32_t* holes = reinterpret_cast<const uint32_t*> (base + holesOffset (h));
+	const Point_2* points = reinterpret_cast<const Point_2*> (base + pointsOffset (h));
+	// the tables must not index outside the arrays
+	bool valid = records[0].firstVertex == 0 && records[0].firstHole == 0 &&
+	             records[h.ncontours].firstVertex == h.nvertices && records[h.ncontours].firstHole == h.nholes;
+	for (uint32_t i = 0; valid && i < h.ncontours; i++)
+		valid = records[i].firstVertex <= records[i + 1].firstVertex && records[i].firstHole <= records[i + 1].firstHole;
+	for (uint32_t i = 0; valid && i < h.nholes; i++)
+		valid = holes[i] < h.ncontours;
+	if (!valid) {
+		close ();
+		return false;
+	}
+	_view = PolygonView (h.ncontours, records, points, holes, Bbox_2 (h.xmin, h.ymin, h.xmax, h.ymax));
+	return true;
+}
+
+void MappedPolygon::close ()
+{
+	file.reset ();
+	_view = PolygonView ();
+}
@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// Binary polygon files, used in place once mapped into memory
+// ------------------------------------------------------------------
+
+#ifndef BINARYPOLYGON_H
+#define BINARYPOLYGON_H
+
+#include <memory>
+#include <string>
+#include "polygonview.h"
+#include "textreader.h"
+
+namespace cbop {
+
+/** @brief Header of a binary polygon file
+ *
+ * The header is followed by the contour table (ncontours + 1 ContourRecord), the hole array (nholes uint32_t,
+ * indexes of contours) padded to a multiple of 8 bytes and the point array (nvertices pairs of doubles x, y).
+ * The numbers are stored with the byte order of the machine that wrote the file, recorded in byteOrder
+ */
+struct BinaryHeader {
+	char magic[4];      // "CBOP"
+	uint32_t version;   // binaryVersion
+	uint32_t byteOrder; // 0x01020304
+	uint32_t ncontours;
+	uint32_t nvertices;
+	uint32_t nholes;
+	double xmin, ymin, xmax, ymax; // bounding box of the polygon
+	uint32_t reserved[2];
+};
+const uint32_t binaryVersion = 1;
+
+/** Is the file a binary polygon file? (it only looks at the magic number) */
+bool isBinaryPolygon (const std::string& filename);
+/** Write p to a binary polygon file. Return false if the file cannot be written */
+bool writeBinary (const PolygonView& p, const std::string& filename);
+inline bool writeBinary (const Polygon& p, const std::string& filename) { return writeBinary (FlatPolygon (p).view (), filename); }
+
+/** @brief Polygon of a binary polygon file mapped into memory
+ *
+ * Opening the file only checks the header and the contour and hole tables: the points are used where they are
+ * in the mapped file. The polygon is accessed through view (), which is valid until the file is closed
+ */
+class MappedPolygon {
+public:
+	MappedPolygon () : file (), _view () {}
+	~MappedPolygon () { close (); }
+	MappedPolygon (const MappedPolygon&) = delete;
+	MappedPolygon& operator= (const MappedPolygon&) = delete;
+	/** Map the file. Return false if it cannot be mapped or it is not a valid binary polygon file of this machine */
+	bool open (const std::string& filename);
+	void close ();
+	const PolygonView& view () const { return _view; }
+
+private:
+	std::unique_ptr<FileText> file;
+	PolygonView _view;
+};
+
+} // end of namespace cbop
+#endif
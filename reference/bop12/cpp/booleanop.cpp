@@ -7,24 +7,29 @@
  ***************************************************************************/
 
 #include <cstdlib>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <limits>
 #include "booleanop.h"
 
 using namespace cbop;
 
-SweepEvent::SweepEvent (bool b, const Point_2& p, SweepEvent* other, PolygonType pt, EdgeType et) : 
-  left (b), point (p), otherEvent (other), pol (pt), type (et), prevInResult (0), inResult (false)
+template <class Kernel>
+BasicSweepEvent<Kernel>::BasicSweepEvent (bool b, const Point& p, SweepEvent* other, PolygonType pt, EdgeType et) : 
+  point (p), otherEvent (other), left (b), pol (pt), type (et), inOut (false), otherInOut (false), inResult (false), red (false), pos (~0u),
+  prevInResult (0)
 {
 }
 
-std::string SweepEvent::toString () const
+template <class Kernel>
+std::string BasicSweepEvent<Kernel>::toString () const
 {
 	std::ostringstream oss;
 	oss << '(' << point.x () << ',' << point.y () << ')';
 	oss << " (" << (left ? "left" : "right") << ')';
-	Segment_2 s (point, otherEvent->point);
+	Segment_2 s (Kernel::toPoint_2 (point), Kernel::toPoint_2 (otherEvent->point));
 	oss << " S:[(" << s.min ().x () << ',' << s.min ().y () << ") - (" << s.max ().x () << ',' << s.max ().y () << ")]";
 	oss << " (" << (pol == SUBJECT ? "SUBJECT" : "CLIPPING") << ')';
 	std::string et[4] =  { "NORMAL", "NON_CONTRIBUTING", "SAME_TRANSITION", "DIFFERENT_TRANSITION" };
@@ -35,24 +40,30 @@ std::string SweepEvent::toString () const
 }
 
 // le1 and le2 are the left events of line segments (le1->point, le1->otherEvent->point) and (le2->point, le2->otherEvent->point)
-bool SegmentComp::operator() (SweepEvent* le1, SweepEvent* le2)
+template <class Kernel>
+bool BasicSegmentComp<Kernel>::operator() (BasicSweepEvent<Kernel>* le1, BasicSweepEvent<Kernel>* le2)
 {
 	if (le1 == le2)
 		return false;
-	if (signedArea (le1->point, le1->otherEvent->point, le2->point) != 0 || 
-		signedArea (le1->point, le1->otherEvent->point, le2->otherEvent->point) != 0) {
-		// Segments are not collinear
+	// The orientations of the endpoints of le2 with respect to le1 tell whether the segments are collinear,
+	// and they are reused to sort them. The orientation of the right endpoint is computed only if it is needed
+	if (le1->point == le2->point) {
 		// If they share their left endpoint use the right endpoint to sort
-		if (le1->point == le2->point)
-			return le1->below (le2->otherEvent->point);
-		// Different left endpoint: use the left endpoint to sort
-		if (le1->point.x () == le2->point.x ())
-			return le1->point.y () < le2->point.y ();
-		SweepEventComp comp;
-		if (comp (le1, le2))  // has the line segment associated to e1 been inserted into S after the line segment associated to e2 ?
-			return le2->above (le1->point);
-		// The line segment associated to e2 has been inserted into S after the line segment associated to e1
-		return le1->below (le2->point);
+		typename Kernel::Area rightArea = le1->orientation (le2->otherEvent->point);
+		if (rightArea != 0) // Segments are not collinear
+			return rightArea > 0; // le1->below (le2->otherEvent->point)
+	} else {
+		typename Kernel::Area leftArea = le1->orientation (le2->point);
+		if (leftArea != 0 || le1->orientation (le2->otherEvent->point) != 0) {
+			// Segments are not collinear. Different left endpoint: use the left endpoint to sort
+			if (le1->point.x () == le2->point.x ())
+				return le1->point.y () < le2->point.y ();
+			// the left endpoints have different x-coordinates, so the event comparison reduces to comparing them
+			if (le1->point.x () > le2->point.x ())  // has the line segment associated to e1 been inserted into S after the line segment associated to e2 ?
+				return le2->above (le1->point);
+			// The line segment associated to e2 has been inserted into S after the line segment associated to e1
+			return leftArea > 0; // le1->below (le2->point)
+		}
 	}
 	// Segments are collinear
 	if (le1->pol != le2->pol)
@@ -60,45 +71,437 @@ bool SegmentComp::operator() (SweepEvent* le1, SweepEvent* le2)
 	// Just a consistent criterion is used
 	if (le1->point == le2->point)
 		return le1 < le2;
-	SweepEventComp comp;
+	BasicSweepEventComp<Kernel> comp;
 	return comp (le1, le2);
 }
 
-BooleanOpImp::BooleanOpImp (const Polygon& subj, const Polygon& clip, Polygon& res, BooleanOpType op 
+namespace {
+/** Copy p into result, the result of a trivial operation */
+inline void assign (Polygon& result, const Polygon& p) { result = p; }
+inline void assign (Polygon& result, const PolygonView& p) { result.clear (); p.append (result); }
+/** Add the contours of p to result, the result of a trivial operation */
+inline void append (Polygon& result, const Polygon& p) { result.join (p); }
+inline void append (Polygon& result, const PolygonView& p) { p.append (result); }
+
+/** Result of an operation known without sweeping the plane */
+enum TrivialResult { NOT_TRIVIAL, EMPTY_RESULT, SUBJECT_RESULT, CLIPPING_RESULT, BOTH_RESULT };
+
+/** Is the result of the operation trivial? It is if one of the polygons is empty or their bounding boxes do not overlap */
+template <class PolygonT>
+TrivialResult trivialResult (const PolygonT& subj, const PolygonT& clip, const Bbox_2& subjectBB, const Bbox_2& clippingBB, BooleanOpType op)
+{
+	// Test 1 for trivial result case: at least one of the polygons is empty
+	bool empty = subj.ncontours () * clip.ncontours () == 0;
+	// Test 2 for trivial result case: the bounding boxes do not overlap
+	bool disjoint = subjectBB.xmin () > clippingBB.xmax () || clippingBB.xmin () > subjectBB.xmax () ||
+	                subjectBB.ymin () > clippingBB.ymax () || clippingBB.ymin () > subjectBB.ymax ();
+	if (!empty && !disjoint)
+		return NOT_TRIVIAL;
+	switch (op) {
+		case DIFFERENCE:
+			return SUBJECT_RESULT;
+		case UNION:
+		case XOR:
+			if (!empty)
+				return BOTH_RESULT;
+			return (subj.ncontours () == 0) ? CLIPPING_RESULT : SUBJECT_RESULT;
+		default:
+			return EMPTY_RESULT;
+	}
+}
+
+/** Order of the events in processing order: e1 is processed before e2 */
+template <class Kernel>
+struct ProcessedBefore {
+	ProcessedBefore (const BasicSweepEventComp<Kernel>& c) : sec (c) {}
+	bool operator() (BasicSweepEvent<Kernel>* e1, BasicSweepEvent<Kernel>* e2) const { return sec (e2, e1); }
+	BasicSweepEventComp<Kernel> sec;
+};
+
+/** Copy p into g in units of the grid of spacing unit, with its vertices snapped to the grid if snap. Consecutive
+ * equal vertices are merged and the contours left with less than three vertices are discarded. Return false if a
+ * vertex is out of the grid */
+bool scaleToGrid (const Polygon& p, double unit, bool snap, Polygon& g)
+{
+	const double gridLimit = 2147483647.0; // 2^31 - 1, so that the products of differences fit in 128 bits
+	g.clear ();
+	for (unsigned int i = 0; i < p.ncontours (); i++) {
+		Contour& c = g.emplace_back ();
+		for (unsigned int j = 0; j < p.contour (i).nvertices (); j++) {
+			Point_2 v (p.contour (i).vertex (j).x () / unit, p.contour (i).vertex (j).y () / unit);
+			if (snap)
+				v = Point_2 (std::floor (v.x () + 0.5), std::floor (v.y () + 0.5));
+			if (!(std::fabs (v.x ()) <= gridLimit && std::fabs (v.y ()) <= gridLimit)) // also false for NaN
+				return false;
+			if (c.nvertices () == 0 || c.back () != v)
+				c.add (v);
+		}
+		while (c.nvertices () > 1 && c.back () == c.vertex (0))
+			c.erase (c.end () - 1);
+		if (c.nvertices () < 3)
+			g.pop_back ();
+	}
+	return true;
+}
+
+/** Clip the segment a + t * (b - a), 0 <= t <= 1, to the pixel (unit square) centered at c. Return false if it does
+ * not cross the pixel, otherwise [t0, t1] is the part inside it (Liang-Barsky) */
+bool clipToPixel (const Point_2& a, const Point_2& b, const Point_2& c, double& t0, double& t1)
+{
+	const double p[4] = { a.x () - b.x (), b.x () - a.x (), a.y () - b.y (), b.y () - a.y () };
+	const double q[4] = { a.x () - (c.x () - 0.5), c.x () + 0.5 - a.x (), a.y () - (c.y () - 0.5), c.y () + 0.5 - a.y () };
+	t0 = 0.0;
+	t1 = 1.0;
+	for (int i = 0; i < 4; i++) {
+		if (p[i] == 0.0) {
+			if (q[i] < 0.0)
+				return false;
+		} else if (p[i] < 0.0) {
+			t0 = std::max (t0, q[i] / p[i]);
+		} else {
+			t1 = std::min (t1, q[i] / p[i]);
+		}
+	}
+	return t0 <= t1;
+}
+
+/** @brief The hot pixels of snapRound, indexed by a uniform grid of buckets with about one pixel per bucket
+ *
+ * The pixels crossed by an edge are searched column by column of buckets, only in the buckets whose rows the
+ * edge passes through in the column
+ */
+class HotPixels {
+public:
+	HotPixels (const std::vector<Point_2>& h) : hot (h)
+	{
+		Bbox_2 box = hot.empty () ? Bbox_2 () : hot[0].bbox ();
+		for (size_t i = 1; i < hot.size (); i++)
+			box = box + hot[i].bbox ();
+		x0 = box.xmin ();
+		y0 = box.ymin ();
+		const double w = box.xmax () - box.xmin (), hgt = box.ymax () - box.ymin (), n = std::max<size_t> (hot.size (), 1);
+		side = std::max (std::max (std::sqrt ((w + 1) * (hgt + 1) / n), (w + hgt) / n), 1.0);
+		nx = static_cast<size_t> (w / side) + 1;
+		ny = static_cast<size_t> (hgt / side) + 1;
+		first.assign (nx * ny + 1, 0);
+		for (size_t i = 0; i < hot.size (); i++)
+			++first[bucket (hot[i]) + 1];
+		for (size_t b = 0; b < nx * ny; b++)
+			first[b + 1] += first[b];
+		pixels.resize (hot.size ());
+		std::vector<size_t> next (first.begin (), first.end () - 1);
+		for (size_t i = 0; i < hot.size (); i++)
+			pixels[next[bucket (hot[i])]++] = i;
+	}
+	/** Append to crossed the hot pixels crossed by the segment (a, b), with the parameters of the part inside them */
+	void crossedBy (const Point_2& a, const Point_2& b, std::vector<std::pair<std::pair<double, double>, unsigned int> >& crossed) const
+	{
+		const double xmin = std::min (a.x (), b.x ()), xmax = std::max (a.x (), b.x ());
+		for (size_t cx = column (xmin - 0.5); cx <= column (xmax + 0.5); cx++) {
+			// the ordinates of the edge where it can be inside the pixels of the column, with a margin for rounding
+			double ylo = std::min (a.y (), b.y ()), yhi = std::max (a.y (), b.y ());
+			if (xmin != xmax) {
+				const double lo = std::max (xmin, x0 + cx * side - 0.5), hi = std::min (xmax, x0 + (cx + 1) * side + 0.5);
+				const double ylo2 = a.y () + (b.y () - a.y ()) * ((lo - a.x ()) / (b.x () - a.x ()));
+				const double yhi2 = a.y () + (b.y () - a.y ()) * ((hi - a.x ()) / (b.x () - a.x ()));
+				ylo = std::max (ylo, std::min (ylo2, yhi2));
+				yhi = std::min (yhi, std::max (ylo2, yhi2));
+			}
+			for (size_t cy = row (ylo - 1.0); cy <= row (yhi + 1.0); cy++) {
+				const size_t b0 = cx * ny + cy;
+				for (size_t k = first[b0]; k < first[b0 + 1]; k++) {
+					double t0, t1;
+					if (clipToPixel (a, b, hot[pixels[k]], t0, t1))
+						crossed.push_back (std::make_pair (std::make_pair (t0, t1), pixels[k]));
+				}
+			}
+		}
+	}
+private:
+	size_t column (double x) const { return clamp ((x - x0) / side, nx); }
+	size_t row (double y) const { return clamp ((y - y0) / side, ny); }
+	size_t bucket (const Point_2& p) const { return column (p.x ()) * ny + row (p.y ()); }
+	static size_t clamp (double c, size_t n) { return c < 0.0 ? 0 : (c >= n - 1 ? n - 1 : static_cast<size_t> (c)); }
+	const std::vector<Point_2>& hot;
+	double x0, y0, side;  // origin and side of the buckets
+	size_t nx, ny;        // columns and rows of buckets
+	std::vector<size_t> first;  // the pixels of the bucket b = column * ny + row are pixels[first[b]..first[b + 1])
+	std::vector<size_t> pixels; // indices in hot
+};
+
+/** @brief Snap round the contours first... of p, whose coordinates are in grid units (hot pixel snap rounding)
+ *
+ * The pixels of the grid points closest to the vertices are hot. Every edge is replaced by the polyline through the
+ * centers of the hot pixels it crosses, in the order in which it enters them, so the rounded edges do not cross,
+ * although they can touch. The repeated vertices and the spikes left by edges collapsed into one are removed, and
+ * so are the contours left with less than three vertices, along with their holes
+ */
+void snapRound (Polygon& p, unsigned int first)
+{
+	std::vector<Point_2> hot;
+	for (unsigned int i = first; i < p.ncontours (); i++)
+		for (unsigned int j = 0; j < p[i].nvertices (); j++)
+			hot.push_back (Point_2 (std::floor (p[i].vertex (j).x () + 0.5), std::floor (p[i].vertex (j).y () + 0.5)));
+	std::sort (hot.begin (), hot.end (), lessXY<Point_2>);
+	hot.erase (std::unique (hot.begin (), hot.end ()), hot.end ());
+	const HotPixels pixels (hot);
+	std::vector<std::pair<std::pair<double, double>, unsigned int> > crossed; // ((entry, exit) parameter, hot pixel)
+	std::vector<Point_2> snapped;
+	std::vector<bool> removed (p.ncontours (), false);
+	for (unsigned int i = first; i < p.ncontours (); i++) {
+		Contour& c = p[i];
+		snapped.clear ();
+		for (unsigned int j = 0; j < c.nvertices (); j++) {
+			const Point_2 a = c.vertex (j);
+			const Point_2 b = c.vertex ((j + 1) % c.nvertices ());
+			crossed.clear ();
+			pixels.crossedBy (a, b, crossed);
+			std::sort (crossed.begin (), crossed.end ());
+			for (unsigned int k = 0; k < crossed.size (); k++) {
+				const Point_2& v = hot[crossed[k].second];
+				if (snapped.size () > 1 && snapped[snapped.size () - 2] == v) // spike
+					snapped.pop_back ();
+				else if (snapped.empty () || snapped.back () != v)
+					snapped.push_back (v);
+			}
+		}
+		// the spikes and repetitions at the start of the contour
+		for (;;) {
+			if (snapped.size () > 1 && snapped.back () == snapped.front ()) {
+				snapped.pop_back ();
+			} else if (snapped.size () > 2 && snapped[snapped.size () - 2] == snapped.front ()) {
+				snapped.pop_back ();
+				snapped.pop_back ();
+			} else if (snapped.size () > 2 && snapped.back () == snapped[1]) {
+				snapped.erase (snapped.begin ());
+				snapped.pop_back ();
+			} else {
+				break;
+			}
+		}
+		while (c.nvertices () > 0)
+			c.erase (c.end () - 1);
+		for (unsigned int j = 0; j < snapped.size (); j++)
+			c.add (snapped[j]);
+		if (c.nvertices () < 3) {
+			removed[i] = true;
+			for (unsigned int j = 0; j < c.nholes (); j++)
+				removed[c.hole (j)] = true;
+		}
+	}
+	// remove the contours, renumbering the holes
+	std::vector<unsigned int> index (p.ncontours ());
+	unsigned int n = 0;
+	for (unsigned int i = 0; i < p.ncontours (); i++) {
+		index[i] = n;
+		if (!removed[i] && n++ != i)
+			p[n - 1] = std::move (p[i]);
+	}
+	while (p.ncontours () > n)
+		p.pop_back ();
+	for (unsigned int i = first; i < n; i++) {
+		std::vector<unsigned int> holes;
+		for (unsigned int j = 0; j < p[i].nholes (); j++)
+			if (!removed[p[i].hole (j)])
+				holes.push_back (index[p[i].hole (j)]);
+		p[i].clearHoles ();
+		for (unsigned int j = 0; j < holes.size (); j++)
+			p[i].addHole (holes[j]);
+	}
+}
+
+/** The rectangle window as a polygon, for the sweep */
+Polygon windowPolygon (const Bbox_2& window)
+{
+	Polygon p;
+	Contour& c = p.emplace_back ();
+	c.add (Point_2 (window.xmin (), window.ymin ()));
+	c.add (Point_2 (window.xmax (), window.ymin ()));
+	c.add (Point_2 (window.xmax (), window.ymax ()));
+	c.add (Point_2 (window.xmin (), window.ymax ()));
+	return p;
+}
+} // end of anonymous namespace
+
+template <class Kernel>
+BasicBooleanOpImp<Kernel>::BasicBooleanOpImp (const Polygon& subj, const Polygon& clip, Polygon& res, BooleanOpType op 
 #ifdef __STEPBYSTEP
 , QSemaphore* ds, QSemaphore* sd, bool t
 #endif
-) : subject (subj), clipping (clip), result (res), operation (op), eq (), sl (), eventHolder ()
+) : subject (&subj), clipping (&clip), result (&res), operation (op), _status (SUCCESS), eq (), sl (), eventHolder (), sortedEvents (), sweepStart (0.0), sweepEnd (0.0), _startEdges (), _endEdges (), _dividedOutside (false), resultEvents (), unsortedEvents (), nextUnprocessed (), prevUnprocessed (), pointRun (), edgeContour (), depth (), holeOf ()
 #ifdef __STEPBYSTEP
 , trace (t), _currentEvent (0), _previousEvent (0), _nextEvent (0), doSomething (ds), somethingDone (sd), out ()
 #endif
 {
 }
 
-void BooleanOpImp::run ()
+template <class Kernel>
+BasicBooleanOpImp<Kernel>::BasicBooleanOpImp () : subject (0), clipping (0), result (0), operation (INTERSECTION), _status (SUCCESS), eq (), sl (), eventHolder (),
+  sortedEvents (), sweepStart (0.0), sweepEnd (0.0), _startEdges (), _endEdges (), _dividedOutside (false), resultEvents (), unsortedEvents (), nextUnprocessed (), prevUnprocessed (), pointRun (), edgeContour (), depth (), holeOf ()
+#ifdef __STEPBYSTEP
+, trace (false), _currentEvent (0), _previousEvent (0), _nextEvent (0), doSomething (0), somethingDone (0), out ()
+#endif
+{
+}
+
+template <class Kernel>
+void BasicEventQueue<Kernel>::pop ()
 {
-	Bbox_2 subjectBB = subject.bbox ();     // for optimizations 1 and 2
-	Bbox_2 clippingBB = clipping.bbox ();   // for optimizations 1 and 2
+	if (fromHeap ()) {
+		std::pop_heap (heap.begin (), heap.end (), sec);
+		heap.pop_back ();
+	} else {
+		sorted.pop_back ();
+	}
+}
+
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::clear ()
+{
+	eq.clear ();
+	sl.clear ();
+	eventHolder.reset ();
+	testedPairs.clear ();
+	_counters = SweepCounters ();
+	sortedEvents.clear ();
+	sweepStart = -std::numeric_limits<double>::infinity ();
+	sweepEnd = std::numeric_limits<double>::infinity ();
+	_startEdges.clear ();
+	_endEdges.clear ();
+	_dividedOutside = false;
+	resultEvents.clear ();
+	depth.clear ();
+	holeOf.clear ();
+}
+
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::run (const Polygon& subj, const Polygon& clip, Polygon& res, BooleanOpType op)
+{
+	subject = &subj;
+	clipping = &clip;
+	result = &res;
+	operation = op;
+	run ();
+}
+
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::run (const PolygonView& subj, const PolygonView& clip, Polygon& res, BooleanOpType op)
+{
+	subject = 0;
+	clipping = 0;
+	result = &res;
+	operation = op;
+	computeOperation (subj, clip);
+}
+
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::run ()
+{
+	computeOperation (*subject, *clipping);
+}
+
+template <class Kernel>
+template <class PolygonT>
+void BasicBooleanOpImp<Kernel>::computeOperation (const PolygonT& subj, const PolygonT& clip)
+{
+	clear ();
+	_status = SUCCESS;
+	Bbox_2 subjectBB = subj.bbox ();     // for optimizations 1 and 2
+	Bbox_2 clippingBB = clip.bbox ();   // for optimizations 1 and 2
 	const double MINMAXX = std::min (subjectBB.xmax (), clippingBB.xmax ()); // for optimization 2
-	if (trivialOperation (subjectBB, clippingBB)) // trivial cases can be quickly resolved without sweeping the plane
+	if (trivialOperation (subj, clip, subjectBB, clippingBB)) // trivial cases can be quickly resolved without sweeping the plane
 		return;
-	for (unsigned int i = 0; i < subject.ncontours (); i++)
-		for (unsigned int j = 0; j < subject.contour (i).nvertices (); j++)
-			processSegment (subject.contour (i).segment (j), SUBJECT);
-	for (unsigned int i = 0; i < clipping.ncontours (); i++)
-		for (unsigned int j = 0; j < clipping.contour (i).nvertices (); j++)
-			processSegment (clipping.contour (i).segment (j), CLIPPING);
-
-	std::set<SweepEvent*, SegmentComp>::iterator it, prev, next;
-	
-	while (! eq.empty ()) {
+	// Edge culling. The edges starting to the right of the end of the sweep (optimization 2) are never processed,
+	// so their events are not created. To the left of the bounding box of one of the polygons only the other
+	// polygon has edges, and none of them can belong to the result. If the sweep of the whole plane reaches an
+	// abscissa there without touching the edges crossing it, the sweep starts at that abscissa: the edges crossing
+	// it are inserted into sl, and the edges to its left are culled. Otherwise the whole plane is swept
+	const double inf = std::numeric_limits<double>::infinity ();
+	double firstX = -inf;
+	double lastX = inf;
+	if (operation == INTERSECTION) {
+		firstX = cullingBoundary (subj, clip, std::max (subjectBB.xmin (), clippingBB.xmin ()));
+		lastX = MINMAXX;
+	} else if (operation == DIFFERENCE) {
+		if (clippingBB.xmin () < subjectBB.xmin ())
+			firstX = cullingBoundary (subj, clip, subjectBB.xmin ());
+		lastX = subjectBB.xmax ();
+	}
+	eq.reserve (2 * (subj.nvertices () + clip.nvertices ()));
+	sortedEvents.reserve (2 * (subj.nvertices () + clip.nvertices ()));
+	processPolygon (subj, SUBJECT, firstX, lastX, false);
+	processPolygon (clip, CLIPPING, firstX, lastX, false);
+	eq.sort ();
+	sweep (MINMAXX, subjectBB.xmax ());
+	if (_status == SUCCESS)
+		connectEdges ();
+}
+
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::sweepSlab (const Polygon& subj, const Polygon& clip, BooleanOpType op, double xmin, double xmax)
+{
+	subject = &subj;
+	clipping = &clip;
+	result = 0;
+	operation = op;
+	clear ();
+	_status = SUCCESS;
+	sweepStart = xmin;
+	sweepEnd = xmax;
+	processPolygon (subj, SUBJECT, xmin, xmax);
+	processPolygon (clip, CLIPPING, xmin, xmax);
+	eq.sort ();
+	// the sweep of the whole plane stops at the same abscissa (optimization 2)
+	Bbox_2 subjectBB = subj.bbox ();
+	Bbox_2 clippingBB = clip.bbox ();
+	sweep (std::min (subjectBB.xmax (), clippingBB.xmax ()), subjectBB.xmax ());
+}
+
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::connect (std::vector<SweepEvent*>& events, Polygon& res)
+{
+	resultEvents.clear ();
+	depth.clear ();
+	holeOf.clear ();
+	sortedEvents.swap (events);
+	events.clear ();
+	result = &res;
+	connectEdges ();
+}
+
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::sweep (const double MINMAXX, const double subjectMaxX)
+{
+	switch (operation) {
+		case INTERSECTION:
+			sweepOperation<INTERSECTION> (MINMAXX, subjectMaxX);
+			break;
+		case UNION:
+			sweepOperation<UNION> (MINMAXX, subjectMaxX);
+			break;
+		case DIFFERENCE:
+			sweepOperation<DIFFERENCE> (MINMAXX, subjectMaxX);
+			break;
+		case XOR:
+			sweepOperation<XOR> (MINMAXX, subjectMaxX);
+			break;
+	}
+}
+
+template <class Kernel>
+template <BooleanOpType Op>
+void BasicBooleanOpImp<Kernel>::sweepOperation (const double MINMAXX, const double subjectMaxX)
+{
+	SweepEvent *prev, *next;
+
+	if (!_startEdges.empty ())
+		insertStartEdges<Op> ();
+	while (! eq.empty () && _status == SUCCESS && !_dividedOutside) {
 		SweepEvent* se = eq.top ();
 		// optimization 2
-		if ((operation == INTERSECTION && se->point.x () > MINMAXX) ||
-			(operation == DIFFERENCE && se->point.x () > subjectBB.xmax ())) {
-			connectEdges ();
+		if ((Op == INTERSECTION && se->point.x () > MINMAXX) ||
+			(Op == DIFFERENCE && se->point.x () > subjectMaxX))
 			return;
-		}
 		sortedEvents.push_back (se);
 #ifdef __STEPBYSTEP
 		if (trace) {
@@ -108,125 +511,254 @@ void BooleanOpImp::run ()
 #endif
 		eq.pop ();
 		if (se->left) { // the line segment must be inserted into sl
-			next = prev = se->posSL = it = sl.insert(se).first;
-			(prev != sl.begin()) ? --prev : prev = sl.end();
-			++next;
+			sl.insert (se);
+			prev = SweepLine::prev (se);
+			next = SweepLine::next (se);
 #ifdef __STEPBYSTEP
 			if (trace) {
-				_currentEvent = *it;
-				_previousEvent = prev != sl.end () ? *prev : 0;
-				_nextEvent = next != sl.end () ? *next : 0;
+				_currentEvent = se;
+				_previousEvent = prev;
+				_nextEvent = next;
 			}
 #endif
-			computeFields (se, prev);
+			computeFields<Op> (se, prev);
 			// Process a possible intersection between "se" and its next neighbor in sl
-			if (next != sl.end()) {
-				if (possibleIntersection(se, *next) == 2) {
-					computeFields (se, prev);
-					computeFields (*next, it);
+			if (next) {
+				if (possibleIntersection(se, next) == 2) {
+					computeFields<Op> (se, prev);
+					computeFields<Op> (next, se);
 				}
 			}
 			// Process a possible intersection between "se" and its previous neighbor in sl
-			if (prev != sl.end ()) {
-				if (possibleIntersection(*prev, se) == 2) {
-					std::set<SweepEvent*, SegmentComp>::iterator prevprev = prev;
-					(prevprev != sl.begin()) ? --prevprev : prevprev = sl.end();
-					computeFields (*prev, prevprev);
-					computeFields (se, prev);
+			if (prev) {
+				if (possibleIntersection(prev, se) == 2) {
+					computeFields<Op> (prev, SweepLine::prev (prev));
+					computeFields<Op> (se, prev);
 				}
 			}
 		} else { // the line segment must be removed from sl
 			se = se->otherEvent; // we work with the left event
-			next = prev = it = se->posSL; // se->posSL; is equal than sl.find (se); but faster
-			(prev != sl.begin()) ? --prev : prev = sl.end();
-			++next;
+			prev = SweepLine::prev (se);
+			next = SweepLine::next (se);
 #ifdef __STEPBYSTEP
 			if (trace) {
-				_currentEvent = *it;
-				_previousEvent = prev != sl.end () ? *prev : 0;
-				_nextEvent = next != sl.end () ? *next : 0;
+				_currentEvent = se;
+				_previousEvent = prev;
+				_nextEvent = next;
 			}
 #endif
 			// delete line segment associated to "se" from sl and check for intersection between the neighbors of "se" in sl
-			sl.erase (it);
-			if (next != sl.end() && prev != sl.end())
-				possibleIntersection (*prev, *next);
+			sl.erase (se);
+			if (next && prev)
+				possibleIntersection (prev, next);
 		}
 #ifdef __STEPBYSTEP
 		if (trace)
 			somethingDone->release ();
 #endif
 	}
-	connectEdges ();
 }
 
-bool BooleanOpImp::trivialOperation (const Bbox_2& subjectBB, const Bbox_2& clippingBB)
-{
-	// Test 1 for trivial result case
-	if (subject.ncontours () * clipping.ncontours () == 0) { // At least one of the polygons is empty
-		if (operation == DIFFERENCE)
-			result = subject;
-		if (operation == UNION || operation == XOR)
-			result = (subject.ncontours () == 0) ? clipping : subject;
-		return true;
-	}
-	// Test 2 for trivial result case
-	if (subjectBB.xmin () > clippingBB.xmax () || clippingBB.xmin () > subjectBB.xmax () ||
-		subjectBB.ymin () > clippingBB.ymax () || clippingBB.ymin () > subjectBB.ymax ()) {
-		// the bounding boxes do not overlap
-		if (operation == DIFFERENCE)
-			result = subject;
-		if (operation == UNION || operation == XOR) {
-			result = subject;
-			result.join (clipping);
-		}
-		return true;
+template <class Kernel>
+template <BooleanOpType Op>
+void BasicBooleanOpImp<Kernel>::insertStartEdges ()
+{
+	// the edges are inserted in the order in which the sweep of the whole plane processes their left events
+	std::vector<SweepEvent*> starts (_startEdges.size ());
+	for (size_t i = 0; i < _startEdges.size (); i++)
+		starts[i] = _startEdges[i].le;
+	std::sort (starts.begin (), starts.end (), ProcessedBefore<Kernel> (sec));
+	for (size_t i = 0; i < starts.size (); i++)
+		sl.insert (starts[i]);
+	// The transitions are computed upwards from the lowest edge. The prevInResult field is the one computed when the
+	// edge was inserted into sl, before the slab: it is left to a placeholder that BatchBooleanOp replaces. When the
+	// edges to the left are culled none of them belongs to the result, so the computed prevInResult is kept
+	for (SweepEvent* le = sl.first (); le; le = SweepLine::next (le))
+		computeFields<Op> (le, SweepLine::prev (le));
+	if (result)
+		return;
+	for (size_t i = 0; i < _startEdges.size (); i++) {
+		SlabStart& start = _startEdges[i];
+		start.below = storeSweepEvent (SweepEvent ());
+		start.le->prevInResult = start.below;
+		start.inOut = start.le->inOut;
+		start.otherInOut = start.le->otherInOut;
 	}
-	return false;
 }
 
-void BooleanOpImp::processSegment (const Segment_2& s, PolygonType pt)
+template <class Kernel>
+template <class PolygonT>
+bool BasicBooleanOpImp<Kernel>::trivialOperation (const PolygonT& subj, const PolygonT& clip, const Bbox_2& subjectBB, const Bbox_2& clippingBB)
+{
+	switch (trivialResult (subj, clip, subjectBB, clippingBB, operation)) {
+		case NOT_TRIVIAL:
+			return false;
+		case EMPTY_RESULT:
+			break;
+		case SUBJECT_RESULT:
+			assign (*result, subj);
+			break;
+		case CLIPPING_RESULT:
+			assign (*result, clip);
+			break;
+		case BOTH_RESULT:
+			assign (*result, subj);
+			append (*result, clip);
+			break;
+	}
+	return true;
+}
+
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::processSegment (const Segment_2& s, PolygonType pt)
 {
 /*	if (s.degenerate ()) // if the two edge endpoints are equal the segment is dicarded
 		return;          // This can be done as preprocessing to avoid "polygons" with less than 3 edges */
-	SweepEvent* e1 = storeSweepEvent (SweepEvent(true, s.source (), 0, pt));
-	SweepEvent* e2 = storeSweepEvent (SweepEvent(true, s.target (), e1, pt));
+	SweepEvent* e1 = storeSweepEvent (SweepEvent(true, Kernel::point (s.source ()), 0, pt));
+	SweepEvent* e2 = storeSweepEvent (SweepEvent(true, Kernel::point (s.target ()), e1, pt));
 	e1->otherEvent = e2;
 
 	if (s.min () == s.source ()) {
 		e2->left = false;
+		e1->setLine ();
 	} else {
 		e1->left = false;
+		e2->setLine ();
 	}
-	eq.push (e1);
-	eq.push (e2);
+	eq.add (e1);
+	eq.add (e2);
 }
 
-void BooleanOpImp::computeFields (SweepEvent* le, const std::set<SweepEvent*, SegmentComp>::iterator& prev)
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::processSlabSegment (const Segment_2& s, PolygonType pt, double xmin, double xmax, bool cutAtXmax)
 {
-	// compute inOut and otherInOut fields
-	if (prev == sl.end ()) {
-		le->inOut = false;
-		le->otherInOut = true;
-	} else if (le->pol == (*prev)->pol) { // previous line segment in sl belongs to the same polygon that "se" belongs to
-		le->inOut = ! (*prev)->inOut;
-		le->otherInOut = (*prev)->otherInOut;
-	} else {                          // previous line segment in sl belongs to a different polygon that "se" belongs to
-		le->inOut = ! (*prev)->otherInOut;
-		le->otherInOut = (*prev)->vertical () ? ! (*prev)->inOut : (*prev)->inOut;
+	const Point_2& lo = s.min ();
+	const Point_2& hi = s.max ();
+	if (hi.x () <= xmin || lo.x () > xmax)
+		return;
+	if (lo.x () > xmin && (hi.x () <= xmax || !cutAtXmax)) {
+		processSegment (s, pt);
+		return;
 	}
-	// compute prevInResult field
-	if (prev != sl.end ())
-		le->prevInResult = (!inResult (*prev) || (*prev)->vertical ()) ? (*prev)->prevInResult : *prev;
-	// check if the line segment belongs to the Boolean operation
-	le->inResult = inResult (le);
+	// The edge crosses a slab boundary: the event beyond the boundary is not swept
+	SweepEvent* le = storeSweepEvent (SweepEvent (true, Kernel::point (lo), 0, pt));
+	SweepEvent* re = storeSweepEvent (SweepEvent (false, Kernel::point (hi), le, pt));
+	le->otherEvent = re;
+	le->setLine ();
+	if (lo.x () > xmin) {
+		eq.add (le);
+	} else {
+		SlabStart start = { le, 0, false, false };
+		_startEdges.push_back (start);
+	}
+	if (hi.x () <= xmax || !cutAtXmax)
+		eq.add (re);
+	else
+		_endEdges.push_back (re);
+}
+
+template <class Kernel>
+template <class PolygonT>
+void BasicBooleanOpImp<Kernel>::processPolygon (const PolygonT& p, PolygonType pt, double xmin, double xmax, bool cutAtXmax)
+{
+	for (unsigned int i = 0; i < p.ncontours (); i++)
+		for (unsigned int j = 0; j < p.contour (i).nvertices (); j++)
+			processSlabSegment (p.contour (i).segment (j), pt, xmin, xmax, cutAtXmax);
+}
+
+template <class Kernel>
+template <class PolygonT>
+double BasicBooleanOpImp<Kernel>::cullingBoundary (const PolygonT& subj, const PolygonT& clip, double x) const
+{
+	// the edges starting to the left of x are all of the same polygon
+	double before = -std::numeric_limits<double>::infinity ();
+	for (int p = 0; p < 2; p++) {
+		const PolygonT& pol = p ? clip : subj;
+		for (unsigned int i = 0; i < pol.ncontours (); i++)
+			for (unsigned int j = 0; j < pol.contour (i).nvertices (); j++)
+				if (pol.contour (i).vertex (j).x () < x)
+					before = std::max (before, pol.contour (i).vertex (j).x ());
+	}
+	const double boundary = (before + x) / 2;
+	if (!(before < boundary && boundary < x))
+		return -std::numeric_limits<double>::infinity ();
+	// The sweep of the whole plane divides an edge crossing the boundary, before reaching it, if the edge touches
+	// another edge starting to the left of the boundary but at an endpoint of both edges. Every edge to the left is
+	// tested against all the crossing edges, so the edges are not culled if too many edges cross the boundary
+	const size_t maxCrossings = 64;
+	std::vector<std::pair<size_t, Segment_2> > crossing;
+	size_t e = 0;
+	for (int p = 0; p < 2; p++) {
+		const PolygonT& pol = p ? clip : subj;
+		for (unsigned int i = 0; i < pol.ncontours (); i++)
+			for (unsigned int j = 0; j < pol.contour (i).nvertices (); j++, e++) {
+				const Segment_2 s = pol.contour (i).segment (j);
+				if (s.min ().x () < boundary && s.max ().x () > boundary) {
+					if (crossing.size () == maxCrossings)
+						return -std::numeric_limits<double>::infinity ();
+					crossing.push_back (std::make_pair (e, s));
+				}
+			}
+	}
+	e = 0;
+	for (int p = 0; p < 2; p++) {
+		const PolygonT& pol = p ? clip : subj;
+		for (unsigned int i = 0; i < pol.ncontours (); i++)
+			for (unsigned int j = 0; j < pol.contour (i).nvertices (); j++, e++) {
+				const Segment_2 b = pol.contour (i).segment (j);
+				if (b.min ().x () >= boundary)
+					continue;
+				const Point b0 = Kernel::point (b.source ());
+				const Point b1 = Kernel::point (b.target ());
+				for (size_t k = 0; k < crossing.size (); k++) {
+					const Segment_2& a = crossing[k].second;
+					const Point a0 = Kernel::point (a.source ());
+					const Point a1 = Kernel::point (a.target ());
+					if (crossing[k].first == e || Kernel::apart (a0, a1, b0, b1))
+						continue;
+					Point ip0, ip1;
+					int n = Kernel::intersection (a0, a1, b0, b1, ip0, ip1);
+					if (n == 2 || (n == 1 && !((ip0 == a0 || ip0 == a1) && (ip0 == b0 || ip0 == b1))))
+						return -std::numeric_limits<double>::infinity ();
+				}
+			}
+	}
+	return boundary;
 }
 
-bool BooleanOpImp::inResult (SweepEvent* le)
+template <class Kernel>
+template <BooleanOpType Op>
+void BasicBooleanOpImp<Kernel>::computeFields (SweepEvent* le, SweepEvent* prev)
+{
+	// compute inOut and otherInOut fields. The XOR does not need them: an edge belongs to it unless it overlaps another edge
+	if (Op != XOR) {
+		if (!prev) {
+			le->inOut = false;
+			le->otherInOut = true;
+		} else if (le->pol == prev->pol) { // previous line segment in sl belongs to the same polygon that "se" belongs to
+			le->inOut = ! prev->inOut;
+			le->otherInOut = prev->otherInOut;
+		} else {                          // previous line segment in sl belongs to a different polygon that "se" belongs to
+			le->inOut = ! prev->otherInOut;
+			le->otherInOut = prev->vertical () ? ! prev->inOut : prev->inOut;
+		}
+	}
+	// compute prevInResult field. The XOR needs it too: connectEdges follows it to the result edge below the first
+	// edge of a contour, which tells whether the contour is a hole and of which contour
+	if (prev)
+		le->prevInResult = (!inResult<Op> (prev) || prev->vertical ()) ? prev->prevInResult : prev;
+	// check if the line segment belongs to the Boolean operation. For XOR inResult<Op> is folded into le->type == NORMAL,
+	// it is stored because connectEdges selects the result edges with it
+	le->inResult = inResult<Op> (le);
+}
+
+template <class Kernel>
+template <BooleanOpType Op>
+bool BasicBooleanOpImp<Kernel>::inResult (SweepEvent* le)
 {
 	switch (le->type) {
 		case NORMAL:
-			switch (operation) {
+			switch (Op) {
 				case (INTERSECTION):
 					return ! le->otherInOut;
 				case (UNION):
@@ -237,32 +769,51 @@ bool BooleanOpImp::inResult (SweepEvent* le)
 					return true;
 			}
 		case SAME_TRANSITION:
-			return operation == INTERSECTION || operation == UNION;
+			return Op == INTERSECTION || Op == UNION;
 		case DIFFERENT_TRANSITION:
-			return operation == DIFFERENCE;
+			return Op == DIFFERENCE;
 		case NON_CONTRIBUTING:
 			return false;
 	}
 	return false; // just to avoid the compiler warning
 }
 
-int BooleanOpImp::possibleIntersection (SweepEvent* le1, SweepEvent* le2)
+template <class Kernel>
+int BasicBooleanOpImp<Kernel>::possibleIntersection (SweepEvent* le1, SweepEvent* le2)
 {
 //	if (e1->pol == e2->pol) // you can uncomment these two lines if self-intersecting polygons are not allowed
 //		return 0;
 
-	Point_2 ip1, ip2;  // intersection points
+	++_counters.neighbourPairs;
+	// The edges do not intersect if their bounding boxes are apart (by more than the tolerances of the kernel)
+	const Point& l1 = le1->point;
+	const Point& r1 = le1->otherEvent->point;
+	const Point& l2 = le2->point;
+	const Point& r2 = le2->otherEvent->point;
+	if (Kernel::apart (l1, r1, l2, r2))
+		return 0;
+	// Neighbours in sl that are separated by an edge become neighbours again when that edge is removed
+	if (testedPairs.contains (le1, le2))
+		return 0;
+
+	Point ip1, ip2;  // intersection points
 	int nintersections;
 
-	if (!(nintersections = findIntersection(le1->segment (), le2->segment (), ip1, ip2)))
+	++_counters.intersectionTests;
+	nintersections = Kernel::intersection (l1, r1, l2, r2, ip1, ip2);
+	if (!nintersections) {
+		testedPairs.insert (le1, le2);
 		return 0;  // no intersection
+	}
 
-	if ((nintersections == 1) && ((le1->point == le2->point) || (le1->otherEvent->point == le2->otherEvent->point)))
+	if ((nintersections == 1) && ((le1->point == le2->point) || (le1->otherEvent->point == le2->otherEvent->point))) {
+		testedPairs.insert (le1, le2);
 		return 0; // the line segments intersect at an endpoint of both line segments
+	}
 
 	if (nintersections == 2 && le1->pol == le2->pol) {
-		std::cerr << "Sorry, edges of the same polygon overlap\n";
-		exit (1); // the line segments overlap, but they belong to the same polygon
+		_status = OVERLAPPING_EDGES; // the line segments overlap, but they belong to the same polygon
+		return 0;
 	}
 
 	// The line segments associated to le1 and le2 intersect
@@ -274,35 +825,36 @@ int BooleanOpImp::possibleIntersection (SweepEvent* le1, SweepEvent* le2)
 		return 1;
 	}
 	// The line segments associated to le1 and le2 overlap
-	std::vector<SweepEvent*> sortedEvents;
+	SweepEvent* sortedEvents[4];
+	unsigned int nsorted = 0;
 	if (le1->point == le2->point) {
-		sortedEvents.push_back (0);
+		sortedEvents[nsorted++] = 0;
 	} else if (sec (le1, le2)) {
-		sortedEvents.push_back (le2);
-		sortedEvents.push_back (le1);
+		sortedEvents[nsorted++] = le2;
+		sortedEvents[nsorted++] = le1;
 	} else {
-		sortedEvents.push_back (le1);
-		sortedEvents.push_back (le2);
+		sortedEvents[nsorted++] = le1;
+		sortedEvents[nsorted++] = le2;
 	}
 	if (le1->otherEvent->point == le2->otherEvent->point) {
-		sortedEvents.push_back (0);
+		sortedEvents[nsorted++] = 0;
 	} else if (sec (le1->otherEvent, le2->otherEvent)) {
-		sortedEvents.push_back (le2->otherEvent);
-		sortedEvents.push_back (le1->otherEvent);
+		sortedEvents[nsorted++] = le2->otherEvent;
+		sortedEvents[nsorted++] = le1->otherEvent;
 	} else {
-		sortedEvents.push_back (le1->otherEvent);
-		sortedEvents.push_back (le2->otherEvent);
+		sortedEvents[nsorted++] = le1->otherEvent;
+		sortedEvents[nsorted++] = le2->otherEvent;
 	}
 
-	if ((sortedEvents.size () == 2) || (sortedEvents.size () == 3 && sortedEvents[2])) { 
+	if ((nsorted == 2) || (nsorted == 3 && sortedEvents[2])) { 
 		// both line segments are equal or share the left endpoint
 		le1->type = NON_CONTRIBUTING;
 		le2->type = (le1->inOut == le2->inOut) ? SAME_TRANSITION : DIFFERENT_TRANSITION;
-		if (sortedEvents.size () == 3)
+		if (nsorted == 3)
 			divideSegment (sortedEvents[2]->otherEvent, sortedEvents[1]->point);
 		return 2;
 	}
-	if (sortedEvents.size () == 3) { // the line segments share the right endpoint
+	if (nsorted == 3) { // the line segments share the right endpoint
 		divideSegment (sortedEvents[0], sortedEvents[1]->point);
 		return 3;
 	}
@@ -317,82 +869,98 @@ int BooleanOpImp::possibleIntersection (SweepEvent* le1, SweepEvent* le2)
 	return 3;
 }
 
-void BooleanOpImp::divideSegment (SweepEvent* le, const Point_2& p)
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::divideSegment (SweepEvent* le, const Point& p)
 {
 //	std::cout << "YES. INTERSECTION" << std::endl;
+	if (p.x () <= sweepStart || p.x () > sweepEnd) { // the edge crosses a boundary of the slab and its state there changes
+		_dividedOutside = true;
+		return;
+	}
 	// "Right event" of the "left line segment" resulting from dividing le->segment ()
 	SweepEvent* r = storeSweepEvent (SweepEvent (false, p, le, le->pol/*, le->type*/));
 	// "Left event" of the "right line segment" resulting from dividing le->segment ()
 	SweepEvent* l = storeSweepEvent (SweepEvent (true, p, le->otherEvent, le->pol/*, le->other->type*/));
 	if (sec (l, le->otherEvent)) { // avoid a rounding error. The left event would be processed after the right event
-		std::cout << "Oops" << std::endl;
 		le->otherEvent->left = true;
 		l->left = false;
 	}
-	if (sec (le, r)) { // avoid a rounding error. The left event would be processed after the right event
-		std::cout << "Oops2" << std::endl;
-	}
 	le->otherEvent->otherEvent = l;
 	le->otherEvent = r;
+	le->setLine ();
+	(l->left ? l : l->otherEvent)->setLine ();
 	eq.push (l);
 	eq.push (r);
 }
 
-void BooleanOpImp::connectEdges ()
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::connectEdges ()
 {
-	// copy the events in the result polygon to resultEvents array
-	std::vector<SweepEvent*> resultEvents;
+	// copy the events in the result polygon to resultEvents array. Due to overlapping edges the events can be
+	// not wholly sorted: the events that are out of order are moved to unsortedEvents, sorted and merged back
 	resultEvents.reserve (sortedEvents.size ());
-	for (std::deque<SweepEvent*>::const_iterator it = sortedEvents.begin (); it != sortedEvents.end (); it++)
-		if (((*it)->left && (*it)->inResult) || (!(*it)->left && (*it)->otherEvent->inResult))
-			resultEvents.push_back (*it);
-
-	// Due to overlapping edges the resultEvents array can be not wholly sorted
-	bool sorted = false;
-	while (!sorted) {
-		sorted = true;
-		for (unsigned int i = 0; i < resultEvents.size (); ++i) {
-			if (i + 1 < resultEvents.size () && sec (resultEvents[i], resultEvents[i+1])) {
-				std::swap (resultEvents[i], resultEvents[i+1]);
-				sorted = false;
-			}
+	unsortedEvents.clear ();
+	for (typename std::vector<SweepEvent*>::const_iterator it = sortedEvents.begin (); it != sortedEvents.end (); it++)
+		if (((*it)->left && (*it)->inResult) || (!(*it)->left && (*it)->otherEvent->inResult)) {
+			if (resultEvents.empty () || !sec (resultEvents.back (), *it))
+				resultEvents.push_back (*it);
+			else
+				unsortedEvents.push_back (*it);
 		}
+	if (!unsortedEvents.empty ()) {
+		std::stable_sort (unsortedEvents.begin (), unsortedEvents.end (), ProcessedBefore<Kernel> (sec));
+		typename std::vector<SweepEvent*>::iterator middle = resultEvents.insert (resultEvents.end (), unsortedEvents.begin (), unsortedEvents.end ());
+		std::inplace_merge (resultEvents.begin (), middle, resultEvents.end (), ProcessedBefore<Kernel> (sec));
 	}
 
-	for (unsigned int i = 0; i < resultEvents.size (); ++i) {
+	const unsigned int firstContour = result->ncontours ();
+	const int n = resultEvents.size ();
+	nextUnprocessed.resize (n + 1);
+	prevUnprocessed.resize (n);
+	pointRun.resize (n);
+	edgeContour.resize (n);
+	for (int i = 0; i < n; ++i) {
 		resultEvents[i]->pos = i;
 		if (!resultEvents[i]->left)
 			std::swap (resultEvents[i]->pos, resultEvents[i]->otherEvent->pos);
+		nextUnprocessed[i] = prevUnprocessed[i] = i;
+		pointRun[i] = (i > 0 && resultEvents[i]->point == resultEvents[i - 1]->point) ? pointRun[i - 1] : i;
 	}
+	nextUnprocessed[n] = n;
 
-	std::vector<bool> processed (resultEvents.size (), false);
-	std::vector<int> depth;
-	std::vector<int> holeOf;
-	for (unsigned int i = 0; i < resultEvents.size (); i++) {
-		if (processed[i])
+	for (int i = 0; i < n; i++) {
+		if (processed (i))
 			continue;
-		result.push_back (Contour ());
-		Contour& contour = result.back ();
-		unsigned int contourId = result.ncontours () - 1;
+		// the closest result edge below the first edge of the contour. pos is only set in the events of the result edges
+		SweepEvent* below = resultEvents[i]->prevInResult;
+		while (below && !below->inResult)
+			below = below->prevInResult;
+		if (below && !processed (below->otherEvent->pos)) {
+			// the contour of the result edge below the first edge of the contour has not been connected yet
+			discardContours (firstContour);
+			return;
+		}
+		Contour& contour = result->emplace_back ();
+		unsigned int contourId = result->ncontours () - 1;
 		depth.push_back (0);
 		holeOf.push_back (-1);
-		if (resultEvents[i]->prevInResult) {
-			unsigned int lowerContourId = resultEvents[i]->prevInResult->contourId;
-			if (!resultEvents[i]->prevInResult->resultInOut) {
-				result[lowerContourId].addHole (contourId);
+		if (below) {
+			unsigned int lowerContourId = edgeContour[below->otherEvent->pos];
+			if (!below->resultInOut) {
+				(*result)[lowerContourId].addHole (contourId);
 				holeOf[contourId] = lowerContourId;
 				depth[contourId] = depth[lowerContourId] + 1;
 				contour.setExternal (false);
-			} else if (!result[lowerContourId].external ()) {
-				result[holeOf[lowerContourId]].addHole (contourId);
+			} else if (!(*result)[lowerContourId].external ()) {
+				(*result)[holeOf[lowerContourId]].addHole (contourId);
 				holeOf[contourId] = holeOf[lowerContourId];
 				depth[contourId] = depth[lowerContourId];
 				contour.setExternal (false);
 			}
 		}
 		int pos = i;
-		Point_2 initial = resultEvents[i]->point;
-		contour.add (initial);
+		Point initial = resultEvents[i]->point;
+		contour.add (Kernel::toPoint_2 (initial));
 		while (resultEvents[pos]->otherEvent->point != initial) {
 #ifdef __STEPBYSTEP
 			if (trace) {
@@ -400,17 +968,20 @@ void BooleanOpImp::connectEdges ()
 				out.push_back (resultEvents[pos]->left ? resultEvents[pos] : resultEvents[pos]->otherEvent);
 			}
 #endif
-			processed[pos] = true; 
+			markProcessed (pos);
 			if (resultEvents[pos]->left) {
 				resultEvents[pos]->resultInOut = false;
-				resultEvents[pos]->contourId = contourId;
+				edgeContour[pos] = contourId;
 			} else {
 				resultEvents[pos]->otherEvent->resultInOut = true; 
-				resultEvents[pos]->otherEvent->contourId = contourId;
+				edgeContour[resultEvents[pos]->pos] = contourId;
+			}
+			markProcessed (pos = resultEvents[pos]->pos);
+			contour.add (Kernel::toPoint_2 (resultEvents[pos]->point));
+			if ((pos = nextPos (pos)) < 0) { // no result edge continues the contour
+				discardContours (firstContour);
+				return;
 			}
-			processed[pos = resultEvents[pos]->pos] = true; 
-			contour.add (resultEvents[pos]->point);
-			pos = nextPos (pos, resultEvents, processed);
 #ifdef __STEPBYSTEP
 			if (trace)
 				somethingDone->release ();
@@ -420,25 +991,134 @@ void BooleanOpImp::connectEdges ()
 		if (trace)
 			out.push_back (resultEvents[pos]->left ? resultEvents[pos] : resultEvents[pos]->otherEvent);
 #endif
-		processed[pos] = processed[resultEvents[pos]->pos] = true;
+		markProcessed (pos);
+		markProcessed (resultEvents[pos]->pos);
 		resultEvents[pos]->otherEvent->resultInOut = true; 
-		resultEvents[pos]->otherEvent->contourId = contourId;
+		edgeContour[resultEvents[pos]->pos] = contourId;
 		if (depth[contourId] & 1)
 			contour.changeOrientation ();
 	}
 }
 
-int BooleanOpImp::nextPos (int pos, const std::vector<SweepEvent*>& resultEvents, const std::vector<bool>& processed)
+template <class Kernel>
+void BasicBooleanOpImp<Kernel>::discardContours (unsigned int firstContour)
+{
+	while (result->ncontours () > firstContour)
+		result->pop_back ();
+	_status = INCONSISTENT_EDGES;
+}
+
+template <class Kernel>
+int BasicBooleanOpImp<Kernel>::nextPos (int pos)
 {
-	unsigned int newPos = pos + 1;
-	while (newPos < resultEvents.size () && resultEvents[newPos]->point == resultEvents[pos]->point) {
-		if (!processed[newPos])
-			return newPos;
-		else
-			++newPos;
+	// an unprocessed event after pos with the same point
+	int newPos = pos + 1;
+	while (nextUnprocessed[newPos] != newPos) {
+		nextUnprocessed[newPos] = nextUnprocessed[nextUnprocessed[newPos]];
+		newPos = nextUnprocessed[newPos];
 	}
+	if (newPos < static_cast<int> (resultEvents.size ()) && pointRun[newPos] == pointRun[pos])
+		return newPos;
+	// otherwise the closest unprocessed event before pos
 	newPos = pos - 1;
-	while (processed[newPos])
-		--newPos;
-	return newPos;
+	while (newPos >= 0 && prevUnprocessed[newPos] != newPos) {
+		int p = prevUnprocessed[newPos];
+		if (p >= 0)
+			prevUnprocessed[newPos] = prevUnprocessed[p];
+		newPos = prevUnprocessed[newPos];
+	}
+	return (newPos >= 0 && pointRun[newPos] == pointRun[pos]) ? newPos : -1;
+}
+
+BooleanOpStatus cbop::compute (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op)
+{
+	if (op == INTERSECTION && convexIntersection (subj, clip, result))
+		return SUCCESS;
+#ifndef __STEPBYSTEP
+	if (subj.nvertices () + clip.nvertices () <= smallOperationSize) {
+		static thread_local BooleanOpImp engine; // the memory it keeps is bounded by the size of the small operations
+		engine.run (subj, clip, result, op);
+		return engine.status ();
+	}
+#endif
+	BooleanOpImp boi (subj, clip, result, op);
+	boi.run ();
+	return boi.status ();
+}
+
+Polygon cbop::compute (Polygon subj, Polygon clip, BooleanOpType op, BooleanOpStatus* status)
+{
+	Polygon result;
+	BooleanOpStatus s = SUCCESS;
+	switch (trivialResult (subj, clip, subj.bbox (), clip.bbox (), op)) {
+		case NOT_TRIVIAL:
+			s = compute (subj, clip, result, op);
+			break;
+		case EMPTY_RESULT:
+			break;
+		case SUBJECT_RESULT:
+			result = std::move (subj);
+			break;
+		case CLIPPING_RESULT:
+			result = std::move (clip);
+			break;
+		case BOTH_RESULT:
+			result = std::move (subj);
+			result.join (std::move (clip));
+			break;
+	}
+	if (status)
+		*status = s;
+	return result;
+}
+
+BooleanOpStatus cbop::clipToRectangle (const Polygon& pol, const Bbox_2& window, Polygon& result)
+{
+	if (rectangleIntersection (pol, window, result))
+		return SUCCESS;
+	return compute (pol, windowPolygon (window), result, INTERSECTION);
 }
+
+BooleanOpStatus BooleanOp::clipToRectangle (const Polygon& pol, const Bbox_2& window, Polygon& result)
+{
+	if (rectangleIntersection (pol, window, result))
+		return SUCCESS;
+	imp.run (pol, windowPolygon (window), result, INTERSECTION);
+	return imp.status ();
+}
+
+BooleanOpStatus BooleanOp::computeOnGrid (const Polygon& subj, const Polygon& clip, Polygon& res, BooleanOpType op, double unit)
+{
+	if (!scaleToGrid (subj, unit, true, gridSubject) || !scaleToGrid (clip, unit, true, gridClipping))
+		return OUT_OF_GRID;
+	unsigned int firstContour = res.ncontours ();
+	gridImp.run (gridSubject, gridClipping, res, op);
+	BooleanOpStatus status = gridImp.status ();
+	if (status != SUCCESS) {
+		// Snapping the vertices or rounding the intersection points moved close edges across or onto each other.
+		// The operation is computed on the operands unsnapped, with the intersection points unrounded, and its
+		// result is snap rounded
+		scaleToGrid (subj, unit, false, gridSubject);
+		scaleToGrid (clip, unit, false, gridClipping);
+		imp.run (gridSubject, gridClipping, res, op);
+		status = imp.status ();
+		if (status == SUCCESS)
+			snapRound (res, firstContour);
+	}
+	for (unsigned int i = firstContour; i < res.ncontours (); i++)
+		for (unsigned int j = 0; j < res.contour (i).nvertices (); j++) {
+			Point_2& v = res.contour (i).vertex (j);
+			v = Point_2 (v.x () * unit, v.y () * unit);
+		}
+	return status;
+}
+
+// The kernels the engine is compiled for. Another kernel needs the same explicit instantiations
+template struct cbop::BasicSweepEvent<DoubleKernel>;
+template struct cbop::BasicSegmentComp<DoubleKernel>;
+template class cbop::BasicEventQueue<DoubleKernel>;
+template class cbop::BasicBooleanOpImp<DoubleKernel>;
+template struct cbop::BasicSweepEvent<GridKernel>;
+template struct cbop::BasicSegmentComp<GridKernel>;
+template class cbop::BasicEventQueue<GridKernel>;
+template class cbop::BasicBooleanOpImp<GridKernel>;
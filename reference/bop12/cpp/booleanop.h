@@ -12,8 +12,7 @@
 #include <vector>
 #include <list>
 #include <string>
-#include <set>
-#include <queue>
+#include <algorithm>
 #include <functional>
 #include <iostream>
 #ifdef __STEPBYSTEP
@@ -22,53 +21,90 @@
 #endif
 
 #include "polygon.h"
+#include "polygonview.h"
+#include "statusline.h"
+#include "arena.h"
+#include "edgepaircache.h"
+#include "kernel.h"
+#include "convex.h"
+#include "rectangle.h"
 
 namespace cbop {
 
 enum BooleanOpType { INTERSECTION, UNION, DIFFERENCE, XOR };
 enum EdgeType { NORMAL, NON_CONTRIBUTING, SAME_TRANSITION, DIFFERENT_TRANSITION };
 enum PolygonType { SUBJECT, CLIPPING };
+/** Outcome of a Boolean operation. No result is computed if the operation fails:
+ * OVERLAPPING_EDGES: two edges of the same polygon overlap
+ * OUT_OF_GRID: a vertex does not fit the integer grid of an operation computed on a grid
+ * INCONSISTENT_EDGES: the result edges cannot be connected into contours */
+enum BooleanOpStatus { SUCCESS, OVERLAPPING_EDGES, OUT_OF_GRID, INCONSISTENT_EDGES };
 
-struct SweepEvent; // forward declaration
-struct SegmentComp : public std::binary_function<SweepEvent*, SweepEvent*, bool> { // for sorting edges in the sweep line (sl)
-	bool operator() (SweepEvent* le1, SweepEvent* le2);
+/** Work done by the sweep of a Boolean operation */
+struct SweepCounters {
+	SweepCounters () : neighbourPairs (0), intersectionTests (0) {}
+	unsigned long neighbourPairs;    // pairs of edges that became neighbours in the sweep line
+	unsigned long intersectionTests; // pairs whose intersection was computed: the others do not overlap in bounding box or were already tested
 };
 
-struct SweepEvent {
-	SweepEvent () {}
-	SweepEvent (bool b, const Point_2& p, SweepEvent* other, PolygonType pt, EdgeType et = NORMAL);
-	bool left;              // is point the left endpoint of the edge (point, otherEvent->point)?
-	Point_2 point;          // point associated with the event
+/* The sweep is parameterized with a geometry kernel (see kernel.h): the types of the engine are class
+ * templates BasicX<Kernel>, and X is BasicX<DoubleKernel> */
+
+template <class Kernel> struct BasicSweepEvent; // forward declaration
+template <class Kernel>
+struct BasicSegmentComp { // for sorting edges in the sweep line (sl)
+	bool operator() (BasicSweepEvent<Kernel>* le1, BasicSweepEvent<Kernel>* le2);
+};
+
+template <class Kernel>
+struct BasicSweepEvent {
+	typedef BasicSweepEvent<Kernel> SweepEvent;
+	typedef typename Kernel::Point Point;
+	typedef typename Kernel::Area Area;
+	BasicSweepEvent () {}
+	BasicSweepEvent (bool b, const Point& p, SweepEvent* other, PolygonType pt, EdgeType et = NORMAL);
+	// Fields read when events and edges are compared. They are placed together at the start of the event
+	Point point;            // point associated with the event
 	SweepEvent* otherEvent; // event associated to the other endpoint of the edge
-	PolygonType pol;        // Polygon to which the associated segment belongs to
-	EdgeType type;
+	typename Kernel::Line line; // line of the edge, only set in "left" events (see setLine)
+	bool left : 1;          // is point the left endpoint of the edge (point, otherEvent->point)?
+	PolygonType pol : 2;    // Polygon to which the associated segment belongs to (one spare bit, enum bit-fields may be signed)
+	EdgeType type : 3;
 	//The following fields are only used in "left" events
 	/**  Does segment (point, otherEvent->p) represent an inside-outside transition in the polygon for a vertical ray from (p.x, -infinite)? */
-	bool inOut;
-	bool otherInOut; // inOut transition for the segment from the other polygon preceding this segment in sl
-	std::set<SweepEvent*, SegmentComp>::iterator posSL; // Position of the event (line segment) in sl
+	bool inOut : 1;
+	bool otherInOut : 1; // inOut transition for the segment from the other polygon preceding this segment in sl
+	bool inResult : 1;
+	bool resultInOut : 1;
+	bool red : 1;           // colour of posSL in the red-black tree of sl
+	unsigned int pos;       // position of the other event of the edge in the result events (connectEdges), ~0u before
+	SLNode<SweepEvent> posSL; // Node of the event (line segment) in sl
 	SweepEvent* prevInResult; // previous segment in sl belonging to the result of the boolean operation
-	bool inResult;
-	unsigned int pos;
-	bool resultInOut;
-	unsigned int contourId;
 	// member functions
+	/** Compute line. It must be called when a left event is created and whenever one of the endpoints of its edge changes */
+	void setLine () { line = Kernel::line (point, otherEvent->point); }
+	/** Orientation of p with respect to the line segment, from its left to its right endpoint: positive if the segment is below p */
+	Area orientation (const Point& p) const
+	{
+		const SweepEvent* le = left ? this : otherEvent;
+		return Kernel::orientation (le->line, le->point, le->otherEvent->point, p);
+	}
 	/** Is the line segment (point, otherEvent->point) below point p */
-	bool below (const Point_2& p) const { return (left) ? signedArea (point, otherEvent->point, p) > 0 : 
-                                                          signedArea (otherEvent->point, point, p) > 0; }
+	bool below (const Point& p) const { return orientation (p) > 0; }
 	/** Is the line segment (point, otherEvent->point) above point p */
-	bool above (const Point_2& p) const { return !below (p); }
+	bool above (const Point& p) const { return !below (p); }
 	/** Is the line segment (point, otherEvent->point) a vertical line segment */
 	bool vertical () const { return point.x () == otherEvent->point.x (); }
 	/** Return the line segment associated to the SweepEvent */
-	Segment_2 segment () const { return Segment_2 (point, otherEvent->point); }
+	Segment_2 segment () const { return Segment_2 (Kernel::toPoint_2 (point), Kernel::toPoint_2 (otherEvent->point)); }
 	std::string toString () const;
 };
 
-struct SweepEventComp : public std::binary_function<SweepEvent, SweepEvent, bool> { // for sorting sweep events
+template <class Kernel>
+struct BasicSweepEventComp { // for sorting sweep events
 // Compare two sweep events
 // Return true means that e1 is placed at the event queue after e2, i.e,, e1 is processed by the algorithm after e2
-bool operator() (const SweepEvent* e1, const SweepEvent* e2)
+bool operator() (const BasicSweepEvent<Kernel>* e1, const BasicSweepEvent<Kernel>* e2) const
 {
 	if (e1->point.x () > e2->point.x ()) // Different x-coordinate
 		return true;
@@ -79,28 +115,105 @@ bool operator() (const SweepEvent* e1, const SweepEvent* e2)
 	if (e1->left != e2->left) // Same point, but one is a left endpoint and the other a right endpoint. The right endpoint is processed first
 		return e1->left;
 	// Same point, both events are left endpoints or both are right endpoints.
-	if (signedArea (e1->point, e1->otherEvent->point, e2->otherEvent->point) != 0) // not collinear
-		return e1->above (e2->otherEvent->point); // the event associate to the bottom segment is processed first
+	typename Kernel::Area area = e1->orientation (e2->otherEvent->point);
+	if (area != 0) // not collinear
+		return area < 0; // e1->above (e2->otherEvent->point): the event associate to the bottom segment is processed first
 	return e1->pol > e2->pol;
 }
 };
 
-class BooleanOpImp
+/** @brief An edge crossing the start of a slab swept by BasicBooleanOpImp::sweepSlab */
+template <class Kernel>
+struct BasicSlabStart {
+	BasicSweepEvent<Kernel>* le;    // left event of the part of the edge crossing the start, inserted into sl before the first event
+	BasicSweepEvent<Kernel>* below; // placeholder stored in le->prevInResult for the prevInResult that le has in the previous slab
+	bool inOut;                     // inOut and otherInOut of le when the sweep of the slab started
+	bool otherInOut;
+};
+
+/** @brief Event queue of the sweep
+ *
+ * The events of the input edges are known before the sweep starts, so they are sorted once into an array
+ * that is consumed from its back. Only the events generated while the plane is swept (by dividing edges)
+ * are kept in a heap, that is merged with the array when the next event is requested.
+ */
+template <class Kernel>
+class BasicEventQueue {
+public:
+	typedef BasicSweepEvent<Kernel> SweepEvent;
+	void reserve (size_t n) { sorted.reserve (n); }
+	/** Add an event of an input edge. All of them must be added before calling sort () */
+	void add (SweepEvent* e) { sorted.push_back (e); }
+	/** Sort the events added with add (). */
+	void sort () { std::sort (sorted.begin (), sorted.end (), sec); } // the event to be processed first ends at the back
+	/** Add an event generated during the sweep */
+	void push (SweepEvent* e) { heap.push_back (e); std::push_heap (heap.begin (), heap.end (), sec); }
+	bool empty () const { return sorted.empty () && heap.empty (); }
+	/** Next event to be processed */
+	SweepEvent* top () const { return fromHeap () ? heap.front () : sorted.back (); }
+	void pop ();
+	/** Remove all the events, keeping the allocated memory */
+	void clear () { sorted.clear (); heap.clear (); }
+private:
+	std::vector<SweepEvent*> sorted;
+	std::vector<SweepEvent*> heap;
+	BasicSweepEventComp<Kernel> sec;
+	bool fromHeap () const { return sorted.empty () || (!heap.empty () && sec (sorted.back (), heap.front ())); }
+};
+
+template <class Kernel>
+class BasicBooleanOpImp
 #ifdef __STEPBYSTEP
  : public QThread
 #endif
 {
 public:
-	BooleanOpImp (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op
+	typedef BasicSweepEvent<Kernel> SweepEvent;
+	typedef typename Kernel::Point Point;
+	typedef StatusLine<SweepEvent, BasicSegmentComp<Kernel>, &SweepEvent::posSL> SweepLine;
+	typedef BasicSlabStart<Kernel> SlabStart;
+	BasicBooleanOpImp (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op
 #ifdef __STEPBYSTEP
 ,QSemaphore* ds = 0, QSemaphore* sd = 0, bool trace = false
 #endif
 );
+	/** @brief Build an object without operands. Operations are computed with run (subj, clip, result, op) */
+	BasicBooleanOpImp ();
 	void run ();
+	/** @brief Compute a new operation. The memory used by previous runs is reused */
+	void run (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op);
+	/** @brief Compute a new operation on polygons stored in flat arrays, such as a MappedPolygon, without copying them */
+	void run (const PolygonView& subj, const PolygonView& clip, Polygon& result, BooleanOpType op);
+	/** @brief Sweep only the slab xmin < x <= xmax, without connecting the result edges
+	 *
+	 * The edges crossing the slab boundaries are not cut, they keep the endpoints and lines they have in the sweep
+	 * of the whole plane. The edges crossing the start (startEdges ()) are inserted into sl before the first event,
+	 * with the fields computed from their order in sl (see SlabStart), and the right events of the edges crossing
+	 * the end (endEdges ()) are not processed. That is the state the sweep of the whole plane leaves at the
+	 * boundaries if it does not divide nor overlap the edges crossing them: then the slab is swept exactly as in
+	 * the sweep of the whole plane. The events processed are available through events () until the next
+	 * computation. Used by BatchBooleanOp::computeInSlabs.
+	 */
+	void sweepSlab (const Polygon& subj, const Polygon& clip, BooleanOpType op, double xmin, double xmax);
+	/** @brief Edges crossing the start (their left events) and the end (their right events, never processed) of the
+	 * slab of the last sweepSlab, in the order of the input edges */
+	const std::vector<SlabStart>& startEdges () const { return _startEdges; }
+	const std::vector<SweepEvent*>& endEdges () const { return _endEdges; }
+	/** @brief Did the last sweepSlab need to divide an edge crossing a boundary of its slab? Then it stopped and its
+	 * sweep is not exact */
+	bool dividedOutside () const { return _dividedOutside; }
+	/** @brief Events processed by the last sweep, in processing order */
+	std::vector<SweepEvent*>& events () { return sortedEvents; }
+	/** @brief Connect the result edges of events, sorted in processing order, into result. events is emptied. See status () */
+	void connect (std::vector<SweepEvent*>& events, Polygon& result);
+	/** @brief Outcome of the last run. The result polygon is not modified by a failed run */
+	BooleanOpStatus status () const { return _status; }
+	/** @brief Counters of the last run */
+	const SweepCounters& counters () const { return _counters; }
 
 #ifdef __STEPBYSTEP
-	typedef std::set<SweepEvent*, SegmentComp>::const_iterator const_sl_iterator;
-	typedef std::deque<SweepEvent*>::const_iterator const_sortedEvents_iterator;
+	typedef SweepLine::const_iterator const_sl_iterator;
+	typedef std::vector<SweepEvent*>::const_iterator const_sortedEvents_iterator;
 	typedef std::vector<SweepEvent*>::const_iterator const_out_iterator;
 	const_sl_iterator beginSL () const { return sl.begin (); }
 	const_sl_iterator endSL () const { return sl.end (); }
@@ -109,53 +222,190 @@ public:
 	SweepEvent* currentEvent () const { return _currentEvent; }
 	SweepEvent* previousEvent () const { return _previousEvent; }
 	SweepEvent* nextEvent () const { return _nextEvent; }
-	Point_2 currentPoint () const { return _currentPoint; }
+	Point currentPoint () const { return _currentPoint; }
 	const_out_iterator beginOut () const { return out.begin (); }
 	const_out_iterator endOut () const { return out.end (); }
 #endif
 private:
-	const Polygon& subject;
-	const Polygon& clipping;
-	Polygon& result;
+	const Polygon* subject;
+	const Polygon* clipping;
+	Polygon* result;
 	BooleanOpType operation;
-	std::priority_queue<SweepEvent*, std::vector<SweepEvent*>, SweepEventComp> eq; // event queue (sorted events to be processed)
-	std::set<SweepEvent*, SegmentComp> sl; // segments intersecting the sweep line
-	std::deque<SweepEvent> eventHolder;    // It holds the events generated during the computation of the boolean operation
-	SweepEventComp sec;                    // to compare events
-	std::deque<SweepEvent*> sortedEvents;
-	bool trivialOperation (const Bbox_2& subjectBB, const Bbox_2& clippingBB);
-	/** @brief Compute the events associated to segment s, and insert them into pq and eq */
+	BooleanOpStatus _status;
+	BasicEventQueue<Kernel> eq;                                    // event queue (sorted events to be processed)
+	SweepLine sl;                          // segments intersecting the sweep line
+	Arena<SweepEvent> eventHolder;         // It holds the events generated during the computation of the boolean operation
+	BasicSweepEventComp<Kernel> sec;       // to compare events
+	EdgePairCache<SweepEvent> testedPairs; // recent pairs of edges (lower, upper) found not to need dividing
+	SweepCounters _counters;
+	std::vector<SweepEvent*> sortedEvents;
+	// slab swept by sweepSlab, the whole plane for the other computations
+	double sweepStart;
+	double sweepEnd;
+	std::vector<SlabStart> _startEdges;
+	std::vector<SweepEvent*> _endEdges;
+	bool _dividedOutside;
+	// used by connectEdges. They are members so that their memory is reused by successive runs
+	std::vector<SweepEvent*> resultEvents;
+	std::vector<SweepEvent*> unsortedEvents;
+	// index of the unprocessed result events: the first unprocessed event at or after (before) position i is
+	// found following nextUnprocessed (prevUnprocessed) from i. pointRun[i] is the position of the first
+	// event of the run of consecutive events sharing the point of the event i
+	std::vector<int> nextUnprocessed;
+	std::vector<int> prevUnprocessed;
+	std::vector<int> pointRun;
+	std::vector<unsigned int> edgeContour; // result contour of the edge whose left event is at position i
+	std::vector<int> depth;
+	std::vector<int> holeOf;
+	/** @brief Discard the state of a previous run, keeping the allocated memory */
+	void clear ();
+	/** @brief Compute the operation between subj and clip into result */
+	template <class PolygonT>
+	void computeOperation (const PolygonT& subj, const PolygonT& clip);
+	template <class PolygonT>
+	bool trivialOperation (const PolygonT& subj, const PolygonT& clip, const Bbox_2& subjectBB, const Bbox_2& clippingBB);
+	/** @brief Process the edges of p between x = xmin and x = xmax. See processSlabSegment */
+	template <class PolygonT>
+	void processPolygon (const PolygonT& p, PolygonType pt, double xmin, double xmax, bool cutAtXmax = true);
+	/** @brief Compute the events associated to segment s, and add them to eq */
 	void processSegment (const Segment_2& s, PolygonType pt);
+	/** @brief Process segment s if it is in the slab xmin < x <= xmax, see sweepSlab. Without cutAtXmax the segments
+	 * starting before xmax are processed up to their right endpoint */
+	void processSlabSegment (const Segment_2& s, PolygonType pt, double xmin, double xmax, bool cutAtXmax = true);
+	/** @brief An abscissa between x and the closest vertex to its left, where the sweep can start. -infinity if there
+	 * is not such a vertex, or the sweep of the whole plane touches an edge crossing the abscissa before reaching it */
+	template <class PolygonT>
+	double cullingBoundary (const PolygonT& subj, const PolygonT& clip, double x) const;
+	/** @brief Process the events of eq. The optimization 2 stops the sweep at x = MINMAXX (intersection) or subjectMaxX (difference)
+	 *
+	 * It calls the instantiation of sweepOperation for the operation, so the tests on the operation done for
+	 * every event and edge are resolved at compile time.
+	 */
+	void sweep (const double MINMAXX, const double subjectMaxX);
+	template <BooleanOpType Op>
+	void sweepOperation (const double MINMAXX, const double subjectMaxX);
+	/** @brief Insert the edges crossing the start of the slab (or of the culled sweep) into sl and compute their fields */
+	template <BooleanOpType Op>
+	void insertStartEdges ();
 	/** @brief Store the SweepEvent e into the event holder, returning the address of e */
-	SweepEvent *storeSweepEvent (const SweepEvent& e) { eventHolder.push_back (e); return &eventHolder.back (); }
+	SweepEvent *storeSweepEvent (const SweepEvent& e) { return eventHolder.store (e); }
 	/** @brief Process a posible intersection between the edges associated to the left events le1 and le2 */
 	int possibleIntersection (SweepEvent* le1, SweepEvent* le2);
 	/** @brief Divide the segment associated to left event le, updating pq and (implicitly) the status line */
-	void divideSegment (SweepEvent* le, const Point_2& p);
-	/** @brief return if the left event le belongs to the result of the Boolean operation */
+	void divideSegment (SweepEvent* le, const Point& p);
+	/** @brief return if the left event le belongs to the result of the Boolean operation Op */
+	template <BooleanOpType Op>
 	bool inResult (SweepEvent* le);
-	/** @brief compute several fields of left event le */
-	void computeFields (SweepEvent* le, const std::set<SweepEvent*, SegmentComp>::iterator& prev);
+	/** @brief compute several fields of left event le. The transitions (inOut, otherInOut) are not computed for XOR,
+	 * prevInResult and inResult are: connectEdges needs them for every operation */
+	template <BooleanOpType Op>
+	void computeFields (SweepEvent* le, SweepEvent* prev);
 	// connect the solution edges to build the result polygon
 	void connectEdges ();
-	int nextPos (int pos, const std::vector<SweepEvent*>& resultEvents, const std::vector<bool>& processed);
+	/** @brief Position of the unprocessed event that continues a contour at the point of the event pos, -1 if there is none */
+	int nextPos (int pos);
+	/** @brief Discard the contours added to result by a failed connection, result had firstContour contours before */
+	void discardContours (unsigned int firstContour);
+	bool processed (int pos) const { return nextUnprocessed[pos] != pos; }
+	void markProcessed (int pos) { nextUnprocessed[pos] = pos + 1; prevUnprocessed[pos] = pos - 1; }
 
 #ifdef __STEPBYSTEP
 	bool trace;
 	SweepEvent* _currentEvent;
 	SweepEvent* _previousEvent;
 	SweepEvent* _nextEvent;
-	Point_2 _currentPoint;
+	Point _currentPoint;
 	QSemaphore* doSomething;
 	QSemaphore* somethingDone;
 	std::vector<SweepEvent*> out;
 #endif
 };
 
-inline void compute (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op)
+typedef BasicSweepEvent<DoubleKernel> SweepEvent;
+typedef BasicSegmentComp<DoubleKernel> SegmentComp;
+typedef BasicSweepEventComp<DoubleKernel> SweepEventComp;
+typedef BasicEventQueue<DoubleKernel> EventQueue;
+typedef BasicBooleanOpImp<DoubleKernel>::SweepLine SweepLine;
+typedef BasicSlabStart<DoubleKernel> SlabStart;
+typedef BasicBooleanOpImp<DoubleKernel> BooleanOpImp;
+typedef BasicBooleanOpImp<GridKernel> GridBooleanOpImp;
+
+/** @brief Compute the Boolean operation op between subj and clip, storing it in result
+ *
+ * The intersection of two convex polygons is computed in linear time by convexIntersection (the sweep computes it
+ * if convexIntersection gives up). The operations on small polygons (up to smallOperationSize vertices in total) are
+ * computed by an engine owned by the calling thread, whose memory is reused by the following small operations: for
+ * a few tens of edges, allocating the memory of a new engine takes as long as the sweep.
+ * Use clipToRectangle to clip a polygon whose edges do not cross to an axis-aligned rectangle in linear time:
+ * compute does not check that precondition, because checking it takes a sweep.
+ */
+BooleanOpStatus compute (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op);
+/** @brief Return the Boolean operation op between subj and clip, and store its outcome in *status if status is not null
+ *
+ * The operands are taken by value: when the result is one of them or both (an operand is empty or their bounding boxes
+ * do not overlap) their contours are moved to the result instead of copied. Pass them with std::move if they are no
+ * longer needed. Otherwise the operation is computed as the other compute does
+ */
+Polygon compute (Polygon subj, Polygon clip, BooleanOpType op, BooleanOpStatus* status = 0);
+const unsigned int smallOperationSize = 128;
+/** @brief Compute the intersection of pol and the axis-aligned rectangle window, storing it in result
+ *
+ * Precondition: the edges of pol do not cross each other or share points other than the vertices of consecutive
+ * edges, as in the polygons computed by the sweep. Then pol is clipped in time linear in its number of vertices by
+ * rectangleIntersection, and the sweep computes the intersection only if the clipper gives up (pol touches the window
+ * boundary, a crossing is too close to a vertex or too many contours lie inside the window). The result is the
+ * one of compute. If the precondition does not hold the result is undefined
+ */
+BooleanOpStatus clipToRectangle (const Polygon& pol, const Bbox_2& window, Polygon& result);
+
+/** @brief Engine for computing many Boolean operations, one after another
+ *
+ * The event queue, the status line, the event storage and the buffers used to connect the result edges
+ * are kept from one operation to the next, so once warmed up the engine only allocates memory for the
+ * result polygons. Useful for computing many operations on small polygons.
+ */
+class BooleanOp {
+public:
+	BooleanOp () : imp (), gridImp (), gridSubject (), gridClipping () {}
+	/** Compute the Boolean operation op between subj and clip, storing it in result. See cbop::compute */
+	BooleanOpStatus compute (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op)
+	{
+		if (op == INTERSECTION && convexIntersection (subj, clip, result))
+			return SUCCESS;
+		imp.run (subj, clip, result, op);
+		return imp.status ();
+	}
+	/** Clip pol to window, storing it in result. See cbop::clipToRectangle */
+	BooleanOpStatus clipToRectangle (const Polygon& pol, const Bbox_2& window, Polygon& result);
+	/** Counters of the last operation computed with compute by the sweep */
+	const SweepCounters& counters () const { return imp.counters (); }
+	/** @brief Compute the Boolean operation op between subj and clip on the integer grid of spacing unit
+	 *
+	 * The vertices are snapped to the closest grid point (consecutive vertices snapped to the same point are
+	 * merged, and contours left with less than three vertices are dropped) and the operation is computed with
+	 * the GridKernel: the intersection points of the edges are rounded to the closest grid point and the
+	 * predicates are exact integer computations, without tolerances. The coordinates divided by unit must be
+	 * smaller than 2^31 in absolute value, otherwise the status is OUT_OF_GRID. The vertices of the result are
+	 * grid points. Snapping the vertices and rounding the intersection points move the edges, and on a coarse grid
+	 * they can move close edges across or onto each other, so that the sweep fails. Then the operation is computed
+	 * on the polygons scaled to the grid, unsnapped, with the DoubleKernel and its result is snap rounded to the
+	 * grid: every edge is routed through the centers of the hot pixels (the pixels of the rounded vertices) it
+	 * crosses, so the result edges do not cross each other, although they can touch. The status is the one of
+	 * that operation.
+	 */
+	BooleanOpStatus computeOnGrid (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op, double unit);
+private:
+	BooleanOpImp imp;
+	GridBooleanOpImp gridImp;
+	Polygon gridSubject; // operands snapped to the grid by computeOnGrid
+	Polygon gridClipping;
+};
+
+/** Compute the Boolean operation op on the grid of spacing unit. See BooleanOp::computeOnGrid */
+inline BooleanOpStatus computeOnGrid (const Polygon& subj, const Polygon& clip, Polygon& result, BooleanOpType op, double unit)
 {
-	BooleanOpImp boi (subj, clip, result, op);
-	boi.run ();
+	BooleanOp engine;
+	return engine.computeOnGrid (subj, clip, result, op, unit);
 }
 
 } // end of namespace cbop
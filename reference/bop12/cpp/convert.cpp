@@ -0,0 +1,37 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "binarypolygon.h"
+#include "polygonwriter.h"
+
+void fatalError (const std::string& message, int exitCode)
+{
+	std::cerr << message;
+	exit (exitCode);
+}
+
+int main (int argc, char* argv[])
+{
+	std::string paramError = "Syntax: " + std::string (argv[0]) + " input output [input output...]\n";
+	paramError += "\tConverts text polygon files to binary polygon files, and binary files back to text\n";
+	if (argc < 3 || argc % 2 == 0)
+		fatalError (paramError, 1);
+	for (int i = 1; i < argc; i += 2) {
+		if (cbop::isBinaryPolygon (argv[i])) {
+			cbop::MappedPolygon mapped;
+			if (! mapped.open (argv[i]))
+				fatalError (std::string (argv[i]) + " is not a valid binary polygon file\n", 3);
+			cbop::Polygon p;
+			mapped.view ().append (p);
+			if (! cbop::writeText (p, argv[i + 1]))
+				fatalError (std::string (argv[i + 1]) + " cannot be written\n", 4);
+		} else {
+			cbop::Polygon p;
+			if (! p.open (argv[i]))
+				fatalError (std::string (argv[i]) + " does not exist or has a bad format\n", 3);
+			if (! cbop::writeBinary (p, argv[i + 1]))
+				fatalError (std::string (argv[i + 1]) + " cannot be written\n", 4);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,189 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include "convex.h"
+
+using namespace cbop;
+
+namespace { // start of anonymous namespace
+
+/** The vertices of a strictly convex contour in counterclockwise order */
+class ConvexContour {
+public:
+	ConvexContour (const Contour& c, bool counterclockwise) : first (c.begin ()), n (c.nvertices ()), ccw (counterclockwise) {}
+	const Point_2& operator[] (unsigned int i) const { return first[ccw ? i : n - 1 - i]; }
+	unsigned int size () const { return n; }
+	unsigned int next (unsigned int i) const { return (i + 1 < n) ? i + 1 : 0; }
+	unsigned int prev (unsigned int i) const { return (i > 0) ? i - 1 : n - 1; }
+private:
+	Contour::const_iterator first;
+	unsigned int n;
+	bool ccw;
+};
+
+/** Is d = a - b computed without rounding? */
+inline bool exactDifference (double a, double b, double d)
+{
+	double bvirt = a - d;
+	double avirt = d + bvirt;
+	return (a - avirt) + (bvirt - b) == 0.0;
+}
+
+/** @brief Sign of the cross product of the directions of the edges (p0, p1) and (q0, q1), 2 if it cannot be told
+ *
+ * The product of the rounded differences of the coordinates is used if it is larger than its error bound. Otherwise
+ * the sign is exact if the differences are, and it is only known if q0 and q1 are not at the same side of the line
+ * of (p0, p1) if they are not
+ */
+int crossSign (const Point_2& p0, const Point_2& p1, const Point_2& q0, const Point_2& q1)
+{
+	const double errBound = 8.8817841970012523e-16; // 8 * eps, the rounding of the differences and of the products
+	Point_2 u (p1.x () - p0.x (), p1.y () - p0.y ());
+	Point_2 v (q1.x () - q0.x (), q1.y () - q0.y ());
+	double detLeft = u.x () * v.y ();
+	double detRight = u.y () * v.x ();
+	double det = detLeft - detRight;
+	if (std::fabs (det) > errBound * (std::fabs (detLeft) + std::fabs (detRight)))
+		return (det > 0) ? 1 : -1;
+	if (exactDifference (p1.x (), p0.x (), u.x ()) && exactDifference (p1.y (), p0.y (), u.y ()) &&
+	    exactDifference (q1.x (), q0.x (), v.x ()) && exactDifference (q1.y (), q0.y (), v.y ()))
+		return sign (Point_2 (0, 0), u, v);
+	// cross (p1 - p0, q1 - q0) = area (p0, p1, q1) - area (p0, p1, q0)
+	int s1 = sign (p0, p1, q1);
+	int s0 = sign (p0, p1, q0);
+	if (s1 == s0)
+		return s1 == 0 ? 0 : 2;
+	return s1 > s0 ? 1 : -1;
+}
+
+/** Is p strictly inside the convex contour c? 2 if p is on its boundary */
+int inside (const Point_2& p, const ConvexContour& c)
+{
+	for (unsigned int i = 0; i < c.size (); i++) {
+		int s = sign (c[i], c[c.next (i)], p);
+		if (s <= 0)
+			return s == 0 ? 2 : 0;
+	}
+	return 1;
+}
+
+/** Add the vertices of c to contour */
+void copy (const ConvexContour& c, Contour& contour)
+{
+	for (unsigned int i = 0; i < c.size (); i++)
+		contour.add (c[i]);
+}
+
+/** The boundary that is inside the other polygon, at the last crossing of the boundaries */
+enum Inside { UNKNOWN, P_INSIDE, Q_INSIDE };
+
+/** @brief Intersection of the convex contours P and Q. Return false if the edges are not in general position
+ *
+ * The edges (P[a - 1], P[a]) and (Q[b - 1], Q[b]) are advanced so that they chase each other along the boundary
+ * of the intersection. The heads of the edges of the boundary that is inside are vertices of the intersection,
+ * as well as the crossings of the boundaries
+ */
+bool intersection (const ConvexContour& P, const ConvexContour& Q, Contour& contour)
+{
+	const unsigned int n = P.size ();
+	const unsigned int m = Q.size ();
+	unsigned int a = 0, b = 0;
+	unsigned int aa = 0, ba = 0; // edges advanced since the first crossing
+	int firstA = -1, firstB = -1; // edges of the first crossing
+	Inside inflag = UNKNOWN;
+	int aTB = 2, bTA = 2; // side of the tail of edge a with respect to edge b and vice versa, 2 if not computed yet
+	do {
+		const Point_2& pa0 = P[P.prev (a)];
+		const Point_2& pa1 = P[a];
+		const Point_2& qb0 = Q[Q.prev (b)];
+		const Point_2& qb1 = Q[b];
+		const int cross = crossSign (pa0, pa1, qb0, qb1);
+		if (cross == 2)
+			return false;
+		const int aHB = sign (qb0, qb1, pa1); // is the head of edge a to the left of edge b?
+		const int bHA = sign (pa0, pa1, qb1);
+		if (aTB == 2)
+			aTB = sign (qb0, qb1, pa0);
+		if (bTA == 2)
+			bTA = sign (pa0, pa1, qb0);
+		if (aHB * aTB < 0 && bHA * bTA < 0) { // proper crossing
+			if (static_cast<int> (a) == firstA && static_cast<int> (b) == firstB)
+				break; // back at the first crossing
+			Point_2 ip0, ip1;
+			Segment_2 sa = (pa0.x () < pa1.x () || (pa0.x () == pa1.x () && pa0.y () < pa1.y ())) ? Segment_2 (pa0, pa1) : Segment_2 (pa1, pa0);
+			Segment_2 sb = (qb0.x () < qb1.x () || (qb0.x () == qb1.x () && qb0.y () < qb1.y ())) ? Segment_2 (qb0, qb1) : Segment_2 (qb1, qb0);
+			if (findIntersection (sa, sb, ip0, ip1) != 1 || ip0 == pa0 || ip0 == pa1 || ip0 == qb0 || ip0 == qb1)
+				return false; // rounded to an endpoint
+			if (firstA < 0) {
+				firstA = a;
+				firstB = b;
+				aa = ba = 0;
+			}
+			contour.add (ip0);
+			inflag = (aHB > 0) ? P_INSIDE : Q_INSIDE;
+		} else if (aHB * aTB <= 0 && bHA * bTA <= 0) { // the edges touch
+			return false;
+		}
+		if (cross == 0 && aHB < 0 && bHA < 0)
+			return true; // parallel edges facing away from each other: the polygons are disjoint
+		if (cross >= 0 ? bHA > 0 : aHB <= 0) {
+			if (inflag == P_INSIDE)
+				contour.add (pa1);
+			a = P.next (a);
+			++aa;
+			aTB = aHB; // the tail of the new edge a is the head of the old one
+			bTA = 2;
+		} else {
+			if (inflag == Q_INSIDE)
+				contour.add (qb1);
+			b = Q.next (b);
+			++ba;
+			bTA = bHA;
+			aTB = 2;
+		}
+	} while ((aa < n || ba < m) && aa < 2 * n && ba < 2 * m);
+	if (firstA >= 0)
+		return contour.nvertices () >= 3 && static_cast<int> (a) == firstA && static_cast<int> (b) == firstB;
+	// the boundaries do not cross
+	int pInQ = inside (P[0], Q);
+	int qInP = inside (Q[0], P);
+	if (pInQ == 2 || qInP == 2)
+		return false;
+	if (pInQ)
+		copy (P, contour);
+	else if (qInP)
+		copy (Q, contour);
+	return true;
+}
+
+} // end of anonymous namespace
+
+bool cbop::convexIntersection (const Polygon& subj, const Polygon& clip, Polygon& result)
+{
+	if (subj.ncontours () != 1 || clip.ncontours () != 1)
+		return false;
+	int subjConvexity = subj[0].convexity ();
+	if (subjConvexity == 0)
+		return false;
+	int clipConvexity = clip[0].convexity ();
+	if (clipConvexity == 0)
+		return false;
+	Contour& contour = result.emplace_back ();
+	bool success = intersection (ConvexContour (subj[0], subjConvexity > 0), ConvexContour (clip[0], clipConvexity > 0), contour);
+	for (Contour::const_iterator it = contour.begin (); success && it != contour.end (); ++it)
+		if (*it == ((it + 1 != contour.end ()) ? *(it + 1) : *contour.begin ()))
+			success = false; // a crossing rounded to a vertex
+	if (!success || contour.nvertices () == 0) {
+		result.pop_back ();
+		return success;
+	}
+	std::rotate (contour.begin (), std::min_element (contour.begin (), contour.end (), lessXY<Point_2>), contour.end ());
+	return true;
+}
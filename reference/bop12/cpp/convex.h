@@ -0,0 +1,31 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// Intersection of convex polygons in linear time
+// ------------------------------------------------------------------
+
+#ifndef CONVEX_H
+#define CONVEX_H
+
+#include "polygon.h"
+
+namespace cbop {
+
+/** @brief Compute the intersection of subj and clip if both are made up of one strictly convex contour (see Contour::convexity)
+ *
+ * The boundaries are advanced together as in the algorithm of O'Rourke, Chien, Olson and Naddor, in time linear in the
+ * number of vertices. The contour of the intersection is added to result as the sweep adds it: counterclockwise and
+ * starting at its leftmost (lowest) vertex. The algorithm needs edges in general position, so it gives up if two edges
+ * touch or are collinear, or if it cannot tell the turn between two edges.
+ * Return false, leaving result unmodified, if the polygons are not convex or the algorithm gave up
+ */
+bool convexIntersection (const Polygon& subj, const Polygon& clip, Polygon& result);
+
+} // end of namespace cbop
+#endif
@@ -0,0 +1,76 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// EdgePairCache Class - Cache of recently seen pairs of edges
+// ------------------------------------------------------------------
+
+#ifndef EDGEPAIRCACHE_H
+#define EDGEPAIRCACHE_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace cbop {
+
+/** @brief Lossy set of ordered pairs of edges, identified by their left events
+ *
+ * An edge is identified by its two events, the left event le and le->otherEvent, so a pair is no longer
+ * found once one of its edges has been divided. The set is a direct-mapped table of Size slots: a pair
+ * evicts the pair stored in its slot, so contains () can miss a pair inserted long ago. Its memory is
+ * fixed and small enough to stay in cache. clear () starts a new generation of the slots, so it takes
+ * constant time.
+ */
+template <class Event, size_t Size = 1024>
+class EdgePairCache {
+public:
+	EdgePairCache () : table (Size), generation (1) {}
+	/** Is the pair of edges (le1, le2) in the cache? */
+	bool contains (const Event* le1, const Event* le2) const
+	{
+		const Slot& s = table[slot (le1, le2)];
+		return s.generation == generation && s.le1 == le1 && s.le2 == le2 && s.re1 == le1->otherEvent && s.re2 == le2->otherEvent;
+	}
+	/** Insert the pair of edges (le1, le2) */
+	void insert (const Event* le1, const Event* le2) { table[slot (le1, le2)] = Slot (generation, le1, le1->otherEvent, le2, le2->otherEvent); }
+	void clear ();
+
+private:
+	struct Slot {
+		Slot () : generation (0), le1 (0), re1 (0), le2 (0), re2 (0) {}
+		Slot (unsigned int g, const Event* l1, const Event* r1, const Event* l2, const Event* r2) :
+			generation (g), le1 (l1), re1 (r1), le2 (l2), re2 (r2) {}
+		unsigned int generation; // the slot is used if it holds the current generation of the cache
+		const Event* le1;
+		const Event* re1;
+		const Event* le2;
+		const Event* re2;
+	};
+	std::vector<Slot> table;
+	unsigned int generation;
+
+	static size_t slot (const Event* le1, const Event* le2)
+	{
+		uint64_t h = reinterpret_cast<uintptr_t> (le1) * 0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t> (le2) * 0xC2B2AE3D27D4EB4Full;
+		return static_cast<size_t> (h >> 32) & (Size - 1); // Size is a power of two
+	}
+};
+
+template <class Event, size_t Size>
+void EdgePairCache<Event, Size>::clear ()
+{
+	if (++generation == 0) { // the generations wrapped around: the stamps of the slots cannot be trusted
+		for (size_t i = 0; i < table.size (); ++i)
+			table[i].generation = 0;
+		generation = 1;
+	}
+}
+
+} // end of namespace cbop
+#endif
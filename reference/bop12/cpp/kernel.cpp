@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+#include <algorithm>
+#include "kernel.h"
+
+using namespace cbop;
+
+namespace {
+typedef GridKernel::int128 int128;
+
+/** n / d rounded to the closest integer, halves away from zero. d > 0 */
+inline int128 roundDiv (int128 n, int128 d)
+{
+	return (n >= 0) ? (2 * n + d) / (2 * d) : -((-2 * n + d) / (2 * d));
+}
+} // end of anonymous namespace
+
+int GridKernel::intersection (const Point& a0, const Point& a1, const Point& b0, const Point& b1, Point& pi0, Point& pi1)
+{
+	const int64_t p0x = a0.x (), p0y = a0.y ();
+	const int64_t q0x = a1.x (), q0y = a1.y ();
+	const int64_t p1x = b0.x (), p1y = b0.y ();
+	const int64_t q1x = b1.x (), q1y = b1.y ();
+	const int64_t d0x = q0x - p0x, d0y = q0y - p0y;
+	const int64_t d1x = q1x - p1x, d1y = q1y - p1y;
+	const int64_t ex = p1x - p0x, ey = p1y - p0y;
+	int128 kross = (int128) d0x * d1y - (int128) d0y * d1x;
+
+	if (kross != 0) {
+		// lines of the segments are not parallel. The intersection is p0 + s * d0 = p1 + t * d1, s = sn / kross, t = tn / kross
+		int128 sn = (int128) ex * d1y - (int128) ey * d1x;
+		int128 tn = (int128) ex * d0y - (int128) ey * d0x;
+		if (kross < 0) {
+			kross = -kross;
+			sn = -sn;
+			tn = -tn;
+		}
+		if (sn < 0 || sn > kross || tn < 0 || tn > kross)
+			return 0;
+		Point ip (p0x + static_cast<int64_t> (roundDiv (sn * d0x, kross)), p0y + static_cast<int64_t> (roundDiv (sn * d0y, kross)));
+		// The rounded point could precede the left endpoint (or follow the right endpoint) of a segment in the
+		// order of the sweep. It is moved to the closest endpoint, so the events of the divided segments keep their order
+		Point l = a0, r = a1;
+		if (lessXY (r, l))
+			std::swap (l, r);
+		if (lessXY (b0, b1)) {
+			if (lessXY (l, b0)) l = b0;
+			if (lessXY (b1, r)) r = b1;
+		} else {
+			if (lessXY (l, b1)) l = b1;
+			if (lessXY (b0, r)) r = b0;
+		}
+		if (lessXY (ip, l))
+			ip = l;
+		else if (lessXY (r, ip))
+			ip = r;
+		pi0 = ip;
+		return 1;
+	}
+
+	// lines of the segments are parallel
+	if ((int128) ex * d0y - (int128) ey * d0x != 0)
+		return 0; // lines of the segments are different
+
+	// Lines of the segments are the same. The overlap is the range between the greatest lower endpoint and the lowest upper endpoint
+	const bool reversed0 = lessXY (a1, a0);
+	const Point& lo0 = reversed0 ? a1 : a0;
+	const Point& hi0 = reversed0 ? a0 : a1;
+	const bool reversed1 = lessXY (b1, b0);
+	const Point& lo1 = reversed1 ? b1 : b0;
+	const Point& hi1 = reversed1 ? b0 : b1;
+	const Point lo = lessXY (lo0, lo1) ? lo1 : lo0;
+	const Point hi = lessXY (hi1, hi0) ? hi1 : hi0;
+	if (lessXY (hi, lo))
+		return 0;
+	if (lo == hi) {
+		pi0 = lo;
+		return 1;
+	}
+	// as in findIntersection the points are sorted from the source of the first segment
+	pi0 = reversed0 ? hi : lo;
+	pi1 = reversed0 ? lo : hi;
+	return 2;
+}
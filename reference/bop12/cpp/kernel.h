@@ -0,0 +1,148 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// Geometry kernels of the Boolean operation engine
+// ------------------------------------------------------------------
+
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+#include "point_2.h"
+#include "segment_2.h"
+#include "utilities.h"
+
+namespace cbop {
+
+/* A kernel is the traits type BasicBooleanOpImp is parameterized with. It provides:
+ *   Point                         the type of the points swept by the engine, with x (), y (), == and !=
+ *   point (p), toPoint_2 (p)      conversions between the points of the input and result polygons and Point
+ *   Area                          the type of the results of the orientation tests
+ *   orientation (p0, p1, p2)      a number with the sign of the signed area of the triangle (p0, p1, p2)
+ *   Line, line (p, q)             the line of the segment (p, q), stored by the sweep events of the edges
+ *   orientation (l, p, q, r)      the same as orientation (p, q, r), where l = line (p, q)
+ *   intersection (a0, a1, b0, b1, ip0, ip1)
+ *                                 intersection of the segments (a0, a1) and (b0, b1), as findIntersection
+ *   apart (a0, a1, b0, b1)        a cheap test done before intersection: true only if intersection finds nothing
+ * The bounding boxes are computed on the input polygons, so a kernel does not need to provide them.
+ */
+
+/** Line through a point p, stored as the direction (dx, dy) of the segment (p, q). The coefficients of its
+ * equation dy * (x - p.x) - dx * (y - p.y) = 0 need no rounding beyond the one of dx and dy */
+template <class FT>
+struct Line_2 {
+	Line_2 () {}
+	Line_2 (FT x, FT y) : dx (x), dy (y) {}
+	FT dx, dy;
+};
+
+/** Double coordinates, exact orientation test and intersections rounded to double with tolerances */
+struct DoubleKernel {
+	typedef Point_2 Point;
+	typedef double Area;
+	typedef Line_2<double> Line;
+	static Point point (const Point_2& p) { return p; }
+	static Point_2 toPoint_2 (const Point& p) { return p; }
+	static Area orientation (const Point& p0, const Point& p1, const Point& p2) { return signedArea (p0, p1, p2); }
+	static Line line (const Point& p, const Point& q) { return Line (q.x () - p.x (), q.y () - p.y ()); }
+	/** The filter of signedArea with p as the common vertex of the two products, whose differences with p are
+	 * already in l. The error bound is the same, so the sign is exact */
+	static Area orientation (const Line& l, const Point& p, const Point& q, const Point& r)
+	{
+		const double ccwErrBoundA = 3.3306690738754716e-16; // (3 + 16 * eps) * eps, eps = 2^-53
+		double detLeft = l.dx * (r.y () - p.y ());
+		double detRight = l.dy * (r.x () - p.x ());
+		double det = detLeft - detRight;
+		if (std::fabs (det) > ccwErrBoundA * (std::fabs (detLeft) + std::fabs (detRight)))
+			return det;
+		return signedArea (p, q, r);
+	}
+	static int intersection (const Point& a0, const Point& a1, const Point& b0, const Point& b1, Point& ip0, Point& ip1)
+	{
+		return findIntersection (Segment_2 (a0, a1), Segment_2 (b0, b1), ip0, ip1);
+	}
+	/** findIntersection finds no intersection if the bounding boxes of the segments are apart by more than its
+	 * tolerances (1e-8 relative to the coordinates), unless it takes the segments as nearly parallel: then it finds
+	 * the overlap of their projections on the same line, even if they are apart */
+	static bool apart (const Point& a0, const Point& a1, const Point& b0, const Point& b1)
+	{
+		const double m = 1e-8 * std::max (std::max (std::max (magnitude (a0), magnitude (a1)), std::max (magnitude (b0), magnitude (b1))), 1.0);
+		if (!((std::max (a0.x (), a1.x ()) + m < std::min (b0.x (), b1.x ())) | (std::max (b0.x (), b1.x ()) + m < std::min (a0.x (), a1.x ())) |
+		      (std::max (a0.y (), a1.y ()) + m < std::min (b0.y (), b1.y ())) | (std::max (b0.y (), b1.y ()) + m < std::min (a0.y (), a1.y ()))))
+			return false;
+		// the test of parallel lines of findIntersection, with the same operations
+		const double sqrEpsilon = 0.0000001;
+		Point_2 d0 (a1.x () - a0.x (), a1.y () - a0.y ());
+		Point_2 d1 (b1.x () - b0.x (), b1.y () - b0.y ());
+		double kross = d0.x () * d1.y () - d0.y () * d1.x ();
+		double sqrLen0 = d0.x () * d0.x () + d0.y () * d0.y ();
+		double sqrLen1 = d1.x () * d1.x () + d1.y () * d1.y ();
+		return kross * kross > sqrEpsilon * sqrLen0 * sqrLen1;
+	}
+private:
+	static double magnitude (const Point& p) { return std::max (std::fabs (p.x ()), std::fabs (p.y ())); }
+};
+
+/** A point with integer coordinates */
+class GridPoint_2 {
+public:
+	GridPoint_2 (int64_t x = 0, int64_t y = 0) : _x (x), _y (y) {}
+	int64_t x () const { return _x; }
+	int64_t y () const { return _y; }
+private:
+	int64_t _x, _y;
+};
+
+inline bool operator== (const GridPoint_2& p1, const GridPoint_2& p2) { return (p1.x () == p2.x ()) && (p1.y () == p2.y ()); }
+inline bool operator!= (const GridPoint_2& p1, const GridPoint_2& p2) { return !(p1 == p2); }
+
+inline std::ostream& operator<< (std::ostream& o, const GridPoint_2& p) {
+	return o << "(" << p.x () << "," << p.y () << ")";
+}
+
+/** @brief Integer coordinates smaller than 2^31 in absolute value
+ *
+ * The orientation test and the intersection test are exact (64-bit differences and 128-bit products).
+ * The intersection points are rounded to integer coordinates, so the edges cannot be cut at any abscissa.
+ * The input polygons must have integer coordinates, see BooleanOp::computeOnGrid.
+ */
+struct GridKernel {
+	typedef GridPoint_2 Point;
+	typedef int Area;
+	typedef Line_2<int64_t> Line;
+	typedef __int128 int128; // GCC and Clang extension
+	static Point point (const Point_2& p) { return Point (static_cast<int64_t> (p.x ()), static_cast<int64_t> (p.y ())); }
+	static Point_2 toPoint_2 (const Point& p) { return Point_2 (static_cast<double> (p.x ()), static_cast<double> (p.y ())); }
+	static Area orientation (const Point& p0, const Point& p1, const Point& p2)
+	{
+		int128 det = (int128) (p0.x () - p2.x ()) * (p1.y () - p2.y ()) - (int128) (p1.x () - p2.x ()) * (p0.y () - p2.y ());
+		return (det < 0 ? -1 : (det > 0 ? +1 : 0));
+	}
+	static Line line (const Point& p, const Point& q) { return Line (q.x () - p.x (), q.y () - p.y ()); }
+	static Area orientation (const Line& l, const Point& p, const Point&, const Point& r)
+	{
+		int128 det = (int128) l.dx * (r.y () - p.y ()) - (int128) l.dy * (r.x () - p.x ());
+		return (det < 0 ? -1 : (det > 0 ? +1 : 0));
+	}
+	/** A crossing point is rounded to the closest point with integer coordinates that is, in the order of the sweep,
+	 * between the left and right endpoints of both segments. An overlap is returned as its two endpoints */
+	static int intersection (const Point& a0, const Point& a1, const Point& b0, const Point& b1, Point& ip0, Point& ip1);
+	/** The intersection test is exact: the segments do not intersect if their bounding boxes do not overlap */
+	static bool apart (const Point& a0, const Point& a1, const Point& b0, const Point& b1)
+	{
+		return (std::max (a0.x (), a1.x ()) < std::min (b0.x (), b1.x ())) | (std::max (b0.x (), b1.x ()) < std::min (a0.x (), a1.x ())) |
+		       (std::max (a0.y (), a1.y ()) < std::min (b0.y (), b1.y ())) | (std::max (b0.y (), b1.y ()) < std::min (a0.y (), a1.y ()));
+	}
+};
+
+} // end of namespace cbop
+#endif
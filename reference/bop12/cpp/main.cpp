@@ -48,10 +48,14 @@ int main (int argc, char* argv[])
 		}
 	}
 
-	cbop::Polygon result;
+	cbop::BooleanOpStatus status;
 	clock_t start = clock ();
-	cbop::compute (subj, clip, result, op);
+	cbop::Polygon result = cbop::compute (std::move (subj), std::move (clip), op, &status);
 	clock_t stop = clock ();
+	if (status == cbop::OVERLAPPING_EDGES)
+		fatalError ("Sorry, edges of the same polygon overlap\n", 1);
+	if (status == cbop::INCONSISTENT_EDGES)
+		fatalError ("Sorry, the result edges could not be connected\n", 1);
 	std::cout << (stop - start) / double (CLOCKS_PER_SEC) << " seconds\n";
 //	std::cout << result;
 	return 0;
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <new>
+#include "booleanop.h"
+
+/** Number of calls to operator new. The counting operators replace the allocator of this program only */
+unsigned long allocations = 0;
+
+void* operator new (std::size_t size)
+{
+	allocations++;
+	if (void* p = std::malloc (size ? size : 1))
+		return p;
+	throw std::bad_alloc ();
+}
+
+void* operator new[] (std::size_t size)
+{
+	return operator new (size);
+}
+
+void operator delete (void* p) noexcept
+{
+	std::free (p);
+}
+
+void operator delete (void* p, std::size_t) noexcept
+{
+	std::free (p);
+}
+
+void operator delete[] (void* p) noexcept
+{
+	std::free (p);
+}
+
+void operator delete[] (void* p, std::size_t) noexcept
+{
+	std::free (p);
+}
+
+void fatalError (const std::string& message, int exitCode)
+{
+	std::cerr << message;
+	exit (exitCode);
+}
+
+/** @brief Polygon made up of n building footprints, unit squares laid out on a grid and shifted by offset, where
+ * every other building has a square courtyard, a hole of its contour
+ */
+cbop::Polygon courtyards (int n, double offset)
+{
+	cbop::Polygon p;
+	int side = 1;
+	while (side * side < n)
+		side++;
+	for (int i = 0; i < n; i++) {
+		double x = (i % side) * 2.0 + offset, y = (i / side) * 2.0 + offset;
+		cbop::Contour& c = p.emplace_back ();
+		c.add (cbop::Point_2 (x, y));
+		c.add (cbop::Point_2 (x + 1.0, y));
+		c.add (cbop::Point_2 (x + 1.0, y + 1.0));
+		c.add (cbop::Point_2 (x, y + 1.0));
+	}
+	for (int i = 0; i < n; i += 2) {
+		const cbop::Point_2 corner = p[i].vertex (0);
+		cbop::Contour& hole = p.emplace_back ();
+		hole.add (cbop::Point_2 (corner.x () + 0.25, corner.y () + 0.25));
+		hole.add (cbop::Point_2 (corner.x () + 0.25, corner.y () + 0.75));
+		hole.add (cbop::Point_2 (corner.x () + 0.75, corner.y () + 0.75));
+		hole.add (cbop::Point_2 (corner.x () + 0.75, corner.y () + 0.25));
+		hole.setExternal (false);
+		p[i].addHole (p.ncontours () - 1);
+	}
+	return p;
+}
+
+/** @brief Count the allocations of joining polygons and of the compute that takes its operands by value, when the
+ * operands are copied and when they are moved
+ *
+ * The operands are n footprints with courtyards, and their bounding boxes do not overlap, so the result is made up
+ * of the operands. Moving them may only allocate the array of contours of the result: return the number of moved
+ * operations that allocate more, which means that a contour is copied instead of moved
+ */
+int main (int argc, char* argv[])
+{
+	std::string paramError = "Syntax: " + std::string (argv[0]) + " contours\n";
+	paramError += "\tCounts the allocations of copying and of moving polygons into a result, fails if the moves copy contours\n";
+	if (argc != 2)
+		fatalError (paramError, 1);
+	int n = atoi (argv[1]);
+	if (n < 1)
+		fatalError (paramError, 2);
+	const cbop::Polygon subj = courtyards (n, 0.0);
+	const cbop::Polygon clip = courtyards (n, 4.0 * n);
+	const cbop::Polygon empty;
+	unsigned long copied[3], moved[3];
+	const unsigned long bound[3] = { 1, 1, 0 };
+	const char* name[3] = { "join", "disjoint union", "difference with an empty polygon" };
+	{
+		cbop::Polygon result (subj), other (clip);
+		unsigned long start = allocations;
+		result.join (other);
+		copied[0] = allocations - start;
+	}
+	{
+		cbop::Polygon result (subj), other (clip);
+		unsigned long start = allocations;
+		result.join (std::move (other));
+		moved[0] = allocations - start;
+	}
+	{
+		unsigned long start = allocations;
+		cbop::Polygon result = cbop::compute (subj, clip, cbop::UNION);
+		copied[1] = allocations - start;
+	}
+	{
+		cbop::Polygon s (subj), c (clip);
+		unsigned long start = allocations;
+		cbop::Polygon result = cbop::compute (std::move (s), std::move (c), cbop::UNION);
+		moved[1] = allocations - start;
+	}
+	{
+		unsigned long start = allocations;
+		cbop::Polygon result = cbop::compute (subj, empty, cbop::DIFFERENCE);
+		copied[2] = allocations - start;
+	}
+	{
+		cbop::Polygon s (subj), c (empty);
+		unsigned long start = allocations;
+		cbop::Polygon result = cbop::compute (std::move (s), std::move (c), cbop::DIFFERENCE);
+		moved[2] = allocations - start;
+	}
+	int regressions = 0;
+	std::cout << subj.ncontours () << " contours per polygon, allocations\n";
+	for (int i = 0; i < 3; i++) {
+		std::cout << "\t" << name[i] << ", copied: " << copied[i] << ", moved: " << moved[i] << " (at most " << bound[i] << ")";
+		if (moved[i] > bound[i]) {
+			std::cout << ", copies in the move path";
+			regressions++;
+		}
+		std::cout << '\n';
+	}
+	return regressions;
+}
@@ -40,6 +40,13 @@ private:
 inline bool operator== (const Point_2& p1, const Point_2& p2) { return (p1.x () == p2.x ()) && (p1.y () == p2.y ()); }
 inline bool operator!= (const Point_2& p1, const Point_2& p2) { return !(p1 == p2); }
 
+/** Lexicographic order of points, the order in which the sweep visits them. Point is Point_2 or the point of a kernel */
+template <class Point>
+inline bool lessXY (const Point& p, const Point& q)
+{
+	return p.x () < q.x () || (p.x () == q.x () && p.y () < q.y ());
+}
+
 inline std::ostream& operator<< (std::ostream& o, const Point_2& p) {
 	return o << "(" << p.x () << "," << p.y () << ")";
 }
@@ -9,11 +9,18 @@
 #include <limits>
 #include <set>
 #include <fstream>
-#include <sstream>
 #include <cstdlib>
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#if defined (__unix__) || defined (__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "polygon.h"
+#include "textreader.h"
 
 using namespace cbop;
 
@@ -39,16 +46,48 @@ bool Contour::counterclockwise ()
 	return _CC = area >= 0.0;
 }
 
+int Contour::convexity () const
+{
+	const unsigned int n = nvertices ();
+	if (n < 3)
+		return 0;
+	int turn = 0;          // side of the turns
+	int firstDirection = 0; // sign of the x-displacement of the first and the last non-vertical edges
+	int direction = 0;
+	int changes = 0;       // changes of sign of the x-displacement along the contour
+	for (unsigned int i = 0, prev = n - 1; i < n; prev = i++) {
+		const Point_2& p = points[i];
+		const Point_2& q = points[i + 1 < n ? i + 1 : 0];
+		int t = sign (points[prev], p, q);
+		if (t == 0 || t == -turn)
+			return 0;
+		turn = t;
+		int d = (q.x () > p.x ()) - (q.x () < p.x ());
+		if (d == 0)
+			continue;
+		if (firstDirection == 0)
+			firstDirection = d;
+		else if (d != direction)
+			++changes;
+		direction = d;
+	}
+	if (direction != firstDirection)
+		++changes;
+	// a contour turning to the same side winds more than once around its interior if it goes back and forth
+	// more than once along the x-axis
+	return changes <= 2 ? turn : 0;
+}
+
 void Contour::move (double x, double y)
 {
 	for (unsigned int i = 0; i < points.size (); i++)
 		points[i] = Point_2 (points[i].x () + x, points[i].y () + y);
 }
 
-std::ostream& cbop::operator<< (std::ostream& o, Contour& c)
+std::ostream& cbop::operator<< (std::ostream& o, const Contour& c)
 {
 	o << c.nvertices () << '\n';
-	Contour::iterator i = c.begin();
+	Contour::const_iterator i = c.begin();
 	while (i != c.end()) {
 		o << '\t' << i->x () << " " << i->y () << '\n';
 		++i;
@@ -56,29 +95,102 @@ std::ostream& cbop::operator<< (std::ostream& o, Contour& c)
 	return o;
 }
 
+FileText::FileText (const std::string& filename) : data (0), size (0), buffer (), _good (false)
+{
+#if defined (__unix__) || defined (__APPLE__)
+	int fd = ::open (filename.c_str (), O_RDONLY);
+	if (fd < 0)
+		return;
+	struct stat st;
+	if (fstat (fd, &st) == 0) {
+		if (st.st_size == 0) {
+			_good = true;
+		} else {
+			void* text = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (text != MAP_FAILED) {
+				madvise (text, st.st_size, MADV_SEQUENTIAL);
+				data = static_cast<const char*> (text);
+				size = st.st_size;
+				_good = true;
+			}
+		}
+	}
+	close (fd);
+#else
+	std::ifstream f (filename.c_str (), std::ios::binary);
+	if (!f)
+		return;
+	buffer.assign ((std::istreambuf_iterator<char> (f)), std::istreambuf_iterator<char> ());
+	data = buffer.data ();
+	size = buffer.size ();
+	_good = true;
+#endif
+}
+
+FileText::~FileText ()
+{
+#if defined (__unix__) || defined (__APPLE__)
+	if (data)
+		munmap (const_cast<char*> (data), size);
+#endif
+}
+
 bool Polygon::open (const std::string& filename)
 {
 	clear ();
-	std::ifstream f (filename.c_str ());
-	if (!f) 
+	FileText text (filename);
+	if (!text.good ())
 		return false;
-	f >> *this;
-	if (! f.eof ()) {
+	if (!parse (text.begin (), text.end ())) {
 		clear ();
 		return false;
 	}
 	return true;
 }
 
+namespace { // start of anonymous namespace
+
+/** Adds the contours read by readPolygonText to a Polygon */
+class PolygonBuilder {
+public:
+	explicit PolygonBuilder (Polygon& pol) : p (pol) {}
+	void reserve (size_t n) { p.reserve (p.ncontours () + n); }
+	void beginContour (size_t n) { p.emplace_back ().reserve (n); }
+	void add (const Point_2& v) { p.back ().add (v); }
+	void endContour () {}
+	void discardContour () { p.pop_back (); }
+	void addHole (unsigned int contour, unsigned int hole) { p[contour].addHole (hole); p[hole].setExternal (false); }
+private:
+	Polygon& p;
+};
+
+} // end of anonymous namespace
+
+bool Polygon::parse (const char* first, const char* last)
+{
+	PolygonBuilder builder (*this);
+	return readPolygonText (first, last, ncontours (), builder);
+}
+
 void Polygon::join (const Polygon& pol)
 {
 	unsigned int size = ncontours ();
-	for (unsigned int i = 0; i < pol.ncontours (); ++i) {
-		push_back (pol.contour (i));
-		back ().clearHoles ();
-		for (unsigned int j = 0; j < pol.contour (i).nholes (); ++j)
-			back ().addHole (pol.contour (i).hole (j) + size);
+	contours.insert (contours.end (), pol.begin (), pol.end ());
+	for (unsigned int i = size; i < ncontours (); ++i)
+		contours[i].offsetHoles (size);
+}
+
+void Polygon::join (Polygon&& pol)
+{
+	if (contours.empty ()) {
+		contours.swap (pol.contours);
+		return;
 	}
+	unsigned int size = ncontours ();
+	contours.insert (contours.end (), std::make_move_iterator (pol.begin ()), std::make_move_iterator (pol.end ()));
+	for (unsigned int i = size; i < ncontours (); ++i)
+		contours[i].offsetHoles (size);
+	pol.clear ();
 }
 
 unsigned Polygon::nvertices () const
@@ -105,9 +217,9 @@ void Polygon::move (double x, double y)
 		contours[i].move (x, y);
 }
 
-std::ostream& cbop::operator<< (std::ostream& o, Polygon& p)
+std::ostream& cbop::operator<< (std::ostream& o, const Polygon& p)
 {
-	o << p.ncontours () << std::endl;
+	o << p.ncontours () << '\n';
 	for (unsigned int i = 0; i < p.ncontours (); i++)   // write the contours
 		o << p.contour (i);
 	for (unsigned int i = 0; i < p.ncontours (); i++) { // write the holes of every contour
@@ -122,46 +234,11 @@ std::ostream& cbop::operator<< (std::ostream& o, Polygon& p)
 
 std::istream& cbop::operator>> (std::istream& is, Polygon& p)
 {
-	// read the contours
-	int ncontours;
-	double px, py;
-	is >> ncontours;
-	for (int i = 0; i < ncontours; i++) {
-		int npoints;
-		is >> npoints;
-		p.push_back (Contour ());
-		Contour& contour = p.back ();
-		for (int j = 0; j < npoints; j++) {
-			is >> px >> py;
-			if (j > 0 && px == contour.back ().x () && py == contour.back ().y ())
-				continue;
-			if (j == npoints-1 && px == contour.vertex (0).x () && py == contour.vertex (0).y ())
-				continue;
-			contour.add (Point_2 (px, py));
-		}
-		if (contour.nvertices () < 3) {
-			p.pop_back ();
-			continue;
-		}
-	}
-	// read holes information
-	int contourId;
-	char aux;
-	std::string restOfLine;
-	while (is >> contourId) {
-		is >> aux; // read the character :
-		if (aux != ':')
-			break;
-		std::getline (is, restOfLine);
-		std::istringstream iss (restOfLine);
-		int hole;
-		while (iss >> hole) {
-			p[contourId].addHole (hole);
-			p[hole].setExternal (false);
-		}
-		if (! iss.eof ())
-			break;
-	}
+	std::string text ((std::istreambuf_iterator<char> (is)), std::istreambuf_iterator<char> ());
+	if (p.parse (text.data (), text.data () + text.size ()))
+		is.setstate (std::ios::eofbit | std::ios::failbit); // as after reading the polygon up to the end of the text
+	else
+		is.setstate (std::ios::failbit);
 	return is;
 }
 
@@ -171,8 +248,8 @@ std::istream& cbop::operator>> (std::istream& is, Polygon& p)
 
 namespace { // start of anonymous namespace
 	struct SweepEvent;
-	struct SegmentComp : public std::binary_function<SweepEvent*, SweepEvent*, bool> {
-		bool operator() (SweepEvent* e1, SweepEvent* e2);
+	struct SegmentComp {
+		bool operator() (SweepEvent* e1, SweepEvent* e2) const;
 	};
 
 	struct SweepEvent {
@@ -195,8 +272,8 @@ namespace { // start of anonymous namespace
 		bool above (const Point_2& p) const { return !below (p); }
 	};
 
-	struct SweepEventComp : public std::binary_function<SweepEvent*, SweepEvent*, bool> {
-		bool operator() (SweepEvent* e1, SweepEvent* e2) {
+	struct SweepEventComp {
+		bool operator() (SweepEvent* e1, SweepEvent* e2) const {
 			if (e1->point.x () < e2->point.x ()) // Different x coordinate
 				return true;
 			if (e2->point.x () < e1->point.x ()) // Different x coordinate
@@ -211,7 +288,7 @@ namespace { // start of anonymous namespace
 	};
 } // end of anonymous namespace
 
-bool SegmentComp::operator() (SweepEvent* le1, SweepEvent* le2) {
+bool SegmentComp::operator() (SweepEvent* le1, SweepEvent* le2) const {
 	if (le1 == le2)
 		return false;
 	if (signedArea (le1->point, le1->otherEvent->point, le2->point) != 0 || 
@@ -10,6 +10,7 @@
 #define POLYGON_H
 
 #include <vector>
+#include <utility>
 #include <algorithm>
 #include "utilities.h"
 #include "bbox_2.h"
@@ -38,12 +39,19 @@ public:
 	bool counterclockwise ();
 	/** Return if the contour is clockwise oriented */
 	bool clockwise () { return !counterclockwise (); }
+	/** @brief Return +1 (-1) if the contour is strictly convex and counterclockwise (clockwise) oriented, 0 otherwise
+	 *
+	 * Strictly convex: the contour turns to the same side, with exact orientation tests, at every vertex and winds once
+	 * around its interior. Repeated and collinear consecutive vertices are not allowed
+	 */
+	int convexity () const;
 	void changeOrientation () { std::reverse (points.begin (), points.end ()); _CC = !_CC; }
 	void setClockwise () { if (counterclockwise ()) changeOrientation (); }
 	void setCounterClockwise () { if (clockwise ()) changeOrientation (); }
 
 	void move (double x, double y);
 	void add (const Point_2& s) { points.push_back (s); }
+	void reserve (unsigned int n) { points.reserve (n); }
 	void erase (iterator i) { points.erase (i); }
 	void clear () { points.clear (); holes.clear (); }
 	void clearHoles () { holes.clear (); }
@@ -54,6 +62,8 @@ public:
 	Point_2& back () { return points.back (); }
 	const Point_2& back () const { return points.back (); }
 	void addHole (unsigned int ind) { holes.push_back (ind); }
+	/** Add offset to the indexes of the holes, when the contour is moved to another polygon */
+	void offsetHoles (unsigned int offset) { for (unsigned int i = 0; i < holes.size (); i++) holes[i] += offset; }
 	unsigned int nholes () const { return holes.size (); }
 	unsigned int hole (unsigned int p) const { return holes[p]; }
 	bool external () const { return _external; }
@@ -69,7 +79,7 @@ public:
 	bool _CC;
 };
 
-std::ostream& operator<< (std::ostream& o, Contour& c);
+std::ostream& operator<< (std::ostream& o, const Contour& c);
 
 class Polygon {
 public:
@@ -80,7 +90,15 @@ public:
 
 	// Get the polygon from a text file */
 	bool open (const std::string& filename);
+	/** @brief Add the contours of the polygon written in the text [first, last), in the format read by open
+	 *
+	 * Consecutive repeated vertices are removed, as well as the last vertex of a contour if it repeats the first one,
+	 * and the contours left with less than 3 vertices are discarded. Return false if the text has a bad format
+	 */
+	bool parse (const char* first, const char* last);
+	/** Add the contours of pol, whose hole indexes are renumbered. The rvalue version moves them instead of copying them */
 	void join (const Polygon& pol);
+	void join (Polygon&& pol);
 	/** Get the p-th contour */
 	Contour& contour (unsigned int p) { return contours[p]; }
 	const Contour& contour (unsigned int p) const { return contours[p]; }
@@ -95,7 +113,11 @@ public:
 
 	void move (double x, double y);
 
-	void push_back (const Contour& c) { contours.push_back (c); } 
+	void push_back (const Contour& c) { contours.push_back (c); }
+	void push_back (Contour&& c) { contours.push_back (std::move (c)); }
+	/** Add an empty contour and return it */
+	Contour& emplace_back () { return contours.emplace_back (); }
+	void reserve (unsigned int n) { contours.reserve (n); }
 	Contour& back () { return contours.back (); }
 	const Contour& back () const { return contours.back (); }
 	void pop_back () { contours.pop_back (); }
@@ -112,7 +134,8 @@ private:
 	std::vector<Contour> contours;
 };
 
-std::ostream& operator<< (std::ostream& o, Polygon& p);
+/** Write p in the text format read by Polygon::open, with the precision of o. PolygonWriter writes it faster and exactly */
+std::ostream& operator<< (std::ostream& o, const Polygon& p);
 std::istream& operator>> (std::istream& i, Polygon& p);
 
 } // end of namespace cbop
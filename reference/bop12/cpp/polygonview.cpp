@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+#include "polygonview.h"
+#include "textreader.h"
+
+using namespace cbop;
+
+void PolygonView::append (Polygon& p) const
+{
+	unsigned int size = p.ncontours ();
+	p.reserve (size + ncontours ());
+	for (unsigned int i = 0; i < ncontours (); ++i) {
+		ContourView c = contour (i);
+		Contour& added = p.emplace_back ();
+		added.reserve (c.nvertices ());
+		for (ContourView::const_iterator it = c.begin (); it != c.end (); ++it)
+			added.add (*it);
+		for (unsigned int j = 0; j < c.nholes (); ++j)
+			added.addHole (c.hole (j) + size);
+		added.setExternal (c.external ());
+	}
+}
+
+FlatPolygon::FlatPolygon (const Polygon& p) : points (), records (1, ContourRecord ()), holes (), box ()
+{
+	reserve (p.ncontours (), p.nvertices ());
+	for (unsigned int i = 0; i < p.ncontours (); ++i) {
+		points.insert (points.end (), p[i].begin (), p[i].end ());
+		closeContour (p[i].external ());
+		for (unsigned int j = 0; j < p[i].nholes (); ++j)
+			addHole (p[i].hole (j));
+	}
+}
+
+void FlatPolygon::clear ()
+{
+	points.clear ();
+	records.assign (1, ContourRecord ());
+	holes.clear ();
+	box = Bbox_2 ();
+}
+
+void FlatPolygon::closeContour (bool external)
+{
+	ContourRecord& r = records.back ();
+	const Point_2* first = points.data () + r.firstVertex;
+	const Point_2* last = points.data () + points.size ();
+	// orientation and bounding box, computed as Contour::counterclockwise and Contour::bbox do
+	double area = 0.0;
+	Bbox_2 b = (first != last) ? first->bbox () : Bbox_2 ();
+	for (const Point_2* v = first; v != last; ++v) {
+		const Point_2& next = (v + 1 != last) ? v[1] : *first;
+		area += v->x () * next.y () - next.x () * v->y ();
+		b = b + v->bbox ();
+	}
+	r.flags = (external ? ContourRecord::EXTERNAL : 0) | (area >= 0.0 ? ContourRecord::COUNTERCLOCKWISE : 0);
+	r.xmin = b.xmin ();
+	r.ymin = b.ymin ();
+	r.xmax = b.xmax ();
+	r.ymax = b.ymax ();
+	box = (ncontours () == 0) ? b : box + b;
+	ContourRecord end = ContourRecord ();
+	end.firstVertex = points.size ();
+	end.firstHole = holes.size ();
+	records.push_back (end);
+}
+
+void FlatPolygon::setHoles (const std::vector<std::pair<uint32_t, uint32_t> >& contourHoles)
+{
+	// counting sort of the holes by contour, keeping the order of the holes of every contour
+	for (unsigned int i = 0; i < records.size (); ++i)
+		records[i].firstHole = 0;
+	for (unsigned int i = 0; i < contourHoles.size (); ++i)
+		++records[contourHoles[i].first + 1].firstHole;
+	for (unsigned int i = 1; i < records.size (); ++i)
+		records[i].firstHole += records[i - 1].firstHole;
+	holes.resize (contourHoles.size ());
+	std::vector<uint32_t> next (records.size ());
+	for (unsigned int i = 0; i < records.size (); ++i)
+		next[i] = records[i].firstHole;
+	for (unsigned int i = 0; i < contourHoles.size (); ++i) {
+		holes[next[contourHoles[i].first]++] = contourHoles[i].second;
+		records[contourHoles[i].second].flags &= ~ContourRecord::EXTERNAL;
+	}
+}
+
+bool FlatPolygon::open (const std::string& filename)
+{
+	clear ();
+	FileText text (filename);
+	if (!text.good ())
+		return false;
+	if (!parse (text.begin (), text.end ())) {
+		clear ();
+		return false;
+	}
+	return true;
+}
+
+bool FlatPolygon::parse (const char* first, const char* last)
+{
+	/** Adds the contours read by readPolygonText, and collects the holes */
+	class Builder {
+	public:
+		explicit Builder (FlatPolygon& pol) : p (pol), contourHoles () {}
+		void reserve (size_t n) { p.records.reserve (p.records.size () + n); }
+		void beginContour (size_t) {} // the points of all the contours are in one array, that grows geometrically
+		void add (const Point_2& v) { p.add (v); }
+		void endContour () { p.closeContour (); }
+		void discardContour () { p.points.resize (p.records.back ().firstVertex); }
+		void addHole (unsigned int contour, unsigned int hole) { contourHoles.push_back (std::make_pair (contour, hole)); }
+		FlatPolygon& p;
+		std::vector<std::pair<uint32_t, uint32_t> > contourHoles;
+	};
+	Builder builder (*this);
+	for (unsigned int i = 0; i < ncontours (); ++i) // the holes already added
+		for (uint32_t j = records[i].firstHole; j < records[i + 1].firstHole; ++j)
+			builder.contourHoles.push_back (std::make_pair (i, holes[j]));
+	bool success = readPolygonText (first, last, ncontours (), builder);
+	setHoles (builder.contourHoles);
+	return success;
+}
@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// Polygons stored in flat arrays
+// ------------------------------------------------------------------
+
+#ifndef POLYGONVIEW_H
+#define POLYGONVIEW_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "polygon.h"
+
+namespace cbop {
+
+/** @brief Entry of the contour table of a flat polygon
+ *
+ * A polygon with n contours has n + 1 records: the vertices of the contour i are the points firstVertex to
+ * next->firstVertex - 1 of the point array, and its holes the entries firstHole to next->firstHole - 1 of
+ * the hole array. The last record only marks the end of both arrays
+ */
+struct ContourRecord {
+	enum { EXTERNAL = 1, COUNTERCLOCKWISE = 2 };
+	uint32_t firstVertex;
+	uint32_t firstHole;
+	uint32_t flags;
+	uint32_t reserved;
+	double xmin, ymin, xmax, ymax; // bounding box
+};
+
+/** @brief Contour of a PolygonView. It has the read-only interface of Contour */
+class ContourView {
+public:
+	typedef const Point_2* const_iterator;
+
+	ContourView (const ContourRecord* r, const Point_2* p, const uint32_t* h) : record (r), points (p + r->firstVertex), holes (h) {}
+	Point_2 vertex (unsigned int p) const { return points[p]; }
+	Segment_2 segment (unsigned int p) const { return (p == nvertices () - 1)
+		? Segment_2 (points[p], points[0])
+		: Segment_2 (points[p], points[p+1]); }
+	unsigned int nvertices () const { return record[1].firstVertex - record[0].firstVertex; }
+	unsigned int nedges () const { return nvertices (); }
+	Bbox_2 bbox () const { return Bbox_2 (record->xmin, record->ymin, record->xmax, record->ymax); }
+	bool counterclockwise () const { return (record->flags & ContourRecord::COUNTERCLOCKWISE) != 0; }
+	bool clockwise () const { return !counterclockwise (); }
+	const_iterator begin () const { return points; }
+	const_iterator end () const { return points + nvertices (); }
+	unsigned int nholes () const { return record[1].firstHole - record[0].firstHole; }
+	unsigned int hole (unsigned int p) const { return holes[record->firstHole + p]; }
+	bool external () const { return (record->flags & ContourRecord::EXTERNAL) != 0; }
+
+private:
+	const ContourRecord* record;
+	const Point_2* points;
+	const uint32_t* holes;
+};
+
+/** @brief Polygon whose points, contour records and holes are stored in arrays owned by someone else
+ *
+ * It has the read-only interface of Polygon, so BooleanOpImp can compute operations on the arrays in place,
+ * for example on a MappedPolygon or a FlatPolygon
+ */
+class PolygonView {
+public:
+	PolygonView () : n (0), records (0), points (0), holes (0), box () {}
+	/** records has ncontours + 1 entries */
+	PolygonView (unsigned int ncontours, const ContourRecord* r, const Point_2* p, const uint32_t* h, const Bbox_2& bb) :
+		n (ncontours), records (r), points (p), holes (h), box (bb) {}
+	ContourView contour (unsigned int p) const { return ContourView (records + p, points, holes); }
+	ContourView operator[] (unsigned int p) const { return contour (p); }
+	unsigned int ncontours () const { return n; }
+	unsigned int nvertices () const { return (n == 0) ? 0 : records[n].firstVertex - records[0].firstVertex; }
+	unsigned int nholes () const { return (n == 0) ? 0 : records[n].firstHole - records[0].firstHole; }
+	Bbox_2 bbox () const { return box; }
+	/** Add the contours to p, as Polygon::join does */
+	void append (Polygon& p) const;
+	/** The arrays: ncontours () + 1 records, the points and the holes */
+	const ContourRecord* contourRecords () const { return records; }
+	const Point_2* pointArray () const { return points; }
+	const uint32_t* holeArray () const { return holes; }
+
+private:
+	unsigned int n;
+	const ContourRecord* records;
+	const Point_2* points;
+	const uint32_t* holes;
+	Bbox_2 box;
+};
+
+/** @brief Polygon stored in three arrays: the points of all its contours, one contour after another, the contour
+ * records and the holes of all its contours
+ *
+ * A polygon with many small contours is stored in three blocks of memory, instead of two per contour as a Polygon,
+ * and its bounding box and number of vertices are kept up to date as the contours are added. BooleanOpImp uses it
+ * through view (). The contours are built adding their vertices with add and then calling closeContour
+ */
+class FlatPolygon {
+public:
+	FlatPolygon () : points (), records (1, ContourRecord ()), holes (), box () {}
+	/** Copy of p */
+	explicit FlatPolygon (const Polygon& p);
+	/** Get the polygon from a text file, in the format read by Polygon::open */
+	bool open (const std::string& filename);
+	/** Add the contours of the polygon written in the text [first, last). See Polygon::parse */
+	bool parse (const char* first, const char* last);
+	unsigned int ncontours () const { return records.size () - 1; }
+	unsigned int nvertices () const { return records.back ().firstVertex; }
+	Bbox_2 bbox () const { return box; }
+	PolygonView view () const { return PolygonView (ncontours (), &records[0], points.data (), holes.data (), box); }
+	void reserve (unsigned int ncontours, unsigned int nvertices) { records.reserve (ncontours + 1); points.reserve (nvertices); }
+	void clear ();
+	/** Add a vertex to the contour being built */
+	void add (const Point_2& p) { points.push_back (p); }
+	/** Add the contour made up of the vertices added since the last closed contour */
+	void closeContour (bool external = true);
+	/** Add the contour hole to the holes of the last closed contour */
+	void addHole (unsigned int hole) { holes.push_back (hole); ++records.back ().firstHole; }
+
+private:
+	std::vector<Point_2> points;
+	std::vector<ContourRecord> records; // ncontours + 1: the last one marks the ends of points and holes
+	std::vector<uint32_t> holes;
+	Bbox_2 box;
+	/** Make the lists of holes. contourHoles holds pairs (contour, hole) */
+	void setHoles (const std::vector<std::pair<uint32_t, uint32_t> >& contourHoles);
+};
+
+} // end of namespace cbop
+#endif
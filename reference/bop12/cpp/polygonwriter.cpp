@@ -0,0 +1,108 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+#include <charconv>
+#include <cerrno>
+#include <fcntl.h>
+#if defined (__unix__) || defined (__APPLE__)
+#include <unistd.h>
+#else
+#include <io.h>
+#include <sys/stat.h>
+#endif
+#include "polygonwriter.h"
+
+using namespace cbop;
+
+void PolygonWriter::put (unsigned int n)
+{
+	used = std::to_chars (&buffer[used], &buffer[used] + maxNumberSize, n).ptr - &buffer[0];
+}
+
+void PolygonWriter::put (double d)
+{
+	used = std::to_chars (&buffer[used], &buffer[used] + maxNumberSize, d).ptr - &buffer[0];
+}
+
+void PolygonWriter::write (const Polygon& p)
+{
+	reserve (1);
+	put (p.ncontours ());
+	put ('\n');
+	for (unsigned int i = 0; i < p.ncontours (); i++) { // write the contours
+		const Contour& c = p.contour (i);
+		reserve (1);
+		put (c.nvertices ());
+		put ('\n');
+		for (Contour::const_iterator it = c.begin (); it != c.end (); ++it) {
+			reserve (2);
+			put ('\t');
+			put (it->x ());
+			put (' ');
+			put (it->y ());
+			put ('\n');
+		}
+	}
+	for (unsigned int i = 0; i < p.ncontours (); i++) { // write the holes of every contour
+		const Contour& c = p.contour (i);
+		if (c.nholes () == 0)
+			continue;
+		reserve (1);
+		put (i);
+		put (':');
+		put (' ');
+		for (unsigned int j = 0; j < c.nholes (); j++) {
+			reserve (1);
+			put (c.hole (j));
+			put (j == c.nholes () - 1 ? '\n' : ' ');
+		}
+	}
+}
+
+bool PolygonWriter::flush ()
+{
+	if (text) {
+		text->append (&buffer[0], used);
+	} else {
+		for (size_t written = 0; _good && written < used; ) {
+#if defined (__unix__) || defined (__APPLE__)
+			ssize_t n = ::write (fd, &buffer[written], used - written);
+#else
+			int n = _write (fd, &buffer[written], used - written);
+#endif
+			if (n > 0)
+				written += n;
+			else if (n == 0 || errno != EINTR)
+				_good = false;
+		}
+	}
+	used = 0;
+	return _good;
+}
+
+bool cbop::writeText (const Polygon& p, const std::string& filename)
+{
+#if defined (__unix__) || defined (__APPLE__)
+	int fd = ::open (filename.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+#else
+	int fd = _open (filename.c_str (), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#endif
+	if (fd < 0)
+		return false;
+	bool success;
+	{
+		PolygonWriter writer (fd);
+		writer.write (p);
+		success = writer.flush ();
+	}
+#if defined (__unix__) || defined (__APPLE__)
+	return (::close (fd) == 0) && success;
+#else
+	return (_close (fd) == 0) && success;
+#endif
+}
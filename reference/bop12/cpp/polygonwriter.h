@@ -0,0 +1,62 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// Buffered writer of the polygon text format
+// ------------------------------------------------------------------
+
+#ifndef POLYGONWRITER_H
+#define POLYGONWRITER_H
+
+#include <string>
+#include <vector>
+#include "polygon.h"
+
+namespace cbop {
+
+/** @brief Writer of polygons in the text format read by Polygon::open
+ *
+ * The text is formatted into a buffer, which is written to a file descriptor when it fills up or is flushed,
+ * or appended to a string. The coordinates are written with std::to_chars, as the shortest text that is read
+ * back as the same double, so the polygons read from the text are the written ones
+ */
+class PolygonWriter {
+public:
+	/** Write to the file descriptor fd, that is not closed by the writer */
+	explicit PolygonWriter (int f) : fd (f), text (0), buffer (bufferSize), used (0), _good (true) {}
+	/** Append to text */
+	explicit PolygonWriter (std::string& t) : fd (-1), text (&t), buffer (bufferSize), used (0), _good (true) {}
+	~PolygonWriter () { flush (); }
+	PolygonWriter (const PolygonWriter&) = delete;
+	PolygonWriter& operator= (const PolygonWriter&) = delete;
+	void write (const Polygon& p);
+	/** Write the buffer to the file descriptor or the string. Return false if any write has failed */
+	bool flush ();
+	bool good () const { return _good; }
+
+private:
+	static const size_t bufferSize = 1 << 16;
+	static const size_t maxNumberSize = 32; // characters of the longest number
+	/** Make room for n numbers and their separators */
+	void reserve (size_t n) { if (used + n * (maxNumberSize + 2) + 2 > bufferSize) flush (); }
+	void put (char c) { buffer[used++] = c; }
+	void put (unsigned int n);
+	void put (double d);
+
+	int fd;
+	std::string* text;
+	std::vector<char> buffer;
+	size_t used; // characters in the buffer
+	bool _good;
+};
+
+/** Write p to a text file with a PolygonWriter. Return false if the file cannot be written */
+bool writeText (const Polygon& p, const std::string& filename);
+
+} // end of namespace cbop
+#endif
@@ -4,6 +4,7 @@
 
 QT += opengl
 DEFINES += __STEPBYSTEP
+CONFIG += c++17
 TEMPLATE = app
 TARGET = 
 DEPENDPATH += .
@@ -12,21 +13,30 @@ INCLUDEPATH += .
 # Input
 HEADERS += ../bbox_2.h \
            ../booleanop.h \
+           ../convex.h \
+           ../rectangle.h \
            drawpolygons.h \
            drawstepbystep.h \
+           ../kernel.h \
            mainwindow.h \
            operationdialog.h \
            ../point_2.h \
            ../polygon.h \
+           ../polygonview.h \
+           ../textreader.h \
            ../segment_2.h \
            stepbystepdialog.h \
            ../utilities.h
 SOURCES += ../booleanop.cpp \
+           ../convex.cpp \
+           ../rectangle.cpp \
            drawpolygons.cpp \
            drawstepbystep.cpp \
+           ../kernel.cpp \
            main.cpp \
            mainwindow.cpp \
            operationdialog.cpp \
            ../polygon.cpp \
+           ../polygonview.cpp \
            stepbystepdialog.cpp \
            ../utilities.cpp
@@ -0,0 +1,486 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include "rectangle.h"
+
+using namespace cbop;
+
+namespace { // start of anonymous namespace
+
+/** A point where an edge crosses the boundary of the window */
+struct Crossing {
+	Point_2 point;
+	int side;   // 0 bottom, 1 right, 2 top, 3 left: the order of a counterclockwise walk from the corner (xmin, ymin)
+	double key; // coordinate along the side, growing in the direction of the walk
+	double t;   // position along the edge, from 0 at its source to 1 at its target
+};
+
+/** @brief An axis-aligned rectangle
+ *
+ * Its corners are numbered counterclockwise from (xmin, ymin), and the side i goes from corner i to corner i + 1
+ */
+class Window {
+public:
+	explicit Window (const Bbox_2& b) : box (b)
+	{
+		corners[0] = Point_2 (b.xmin (), b.ymin ());
+		corners[1] = Point_2 (b.xmax (), b.ymin ());
+		corners[2] = Point_2 (b.xmax (), b.ymax ());
+		corners[3] = Point_2 (b.xmin (), b.ymax ());
+	}
+	const Point_2& corner (int i) const { return corners[i & 3]; }
+	/** 1 if p is inside the window, 0 if it is outside, -1 if it is on the boundary */
+	int locate (const Point_2& p) const;
+	/** 1 if the edge (p, q) crosses the ray from the corner 0 to x = -infinity (counting the endpoints on the ray as
+	 * above it), 0 if it does not, -1 if the corner is on the edge */
+	int crossesRay (const Point_2& p, const Point_2& q) const;
+	/** @brief Crossings of the edge (p, q) with the boundary, in order from p. Return their number
+	 *
+	 * Return -1 if the edge passes through a corner, or if the sweep would not find a crossing as computed here:
+	 * findIntersection takes the edge as parallel to the side or merges the crossing with a close endpoint
+	 */
+	int crossings (const Point_2& p, const Point_2& q, Crossing* out) const;
+private:
+	Bbox_2 box;
+	Point_2 corners[4];
+};
+
+int Window::locate (const Point_2& p) const
+{
+	if (p.x () < box.xmin () || p.x () > box.xmax () || p.y () < box.ymin () || p.y () > box.ymax ())
+		return 0;
+	if (p.x () == box.xmin () || p.x () == box.xmax () || p.y () == box.ymin () || p.y () == box.ymax ())
+		return -1;
+	return 1;
+}
+
+int Window::crossesRay (const Point_2& p, const Point_2& q) const
+{
+	const Point_2& o = corners[0];
+	if ((p.y () > o.y ()) == (q.y () > o.y ()))
+		return 0;
+	if (p.x () > o.x () && q.x () > o.x ())
+		return 0;
+	if (p.x () < o.x () && q.x () < o.x ())
+		return 1;
+	int s = (p.y () < q.y ()) ? sign (p, q, o) : sign (q, p, o);
+	return (s == 0) ? -1 : (s < 0);
+}
+
+int Window::crossings (const Point_2& p, const Point_2& q, Crossing* out) const
+{
+	if (std::max (p.x (), q.x ()) < box.xmin () || std::min (p.x (), q.x ()) > box.xmax () ||
+	    std::max (p.y (), q.y ()) < box.ymin () || std::min (p.y (), q.y ()) > box.ymax ())
+		return 0;
+	// the crossings are interpolated from the leftmost endpoint, so they do not depend on the direction of the edge
+	const Point_2& a = lessXY (p, q) ? p : q;
+	const Point_2& b = lessXY (p, q) ? q : p;
+	const double dx = b.x () - a.x ();
+	const double dy = b.y () - a.y ();
+	int n = 0;
+	for (int side = 0; side < 4; side++) {
+		const bool vertical = side & 1;
+		const double c = (side == 0) ? box.ymin () : (side == 1) ? box.xmax () : (side == 2) ? box.ymax () : box.xmin ();
+		const double cp = vertical ? p.x () : p.y ();
+		const double cq = vertical ? q.x () : q.y ();
+		if (!((cp < c && c < cq) || (cq < c && c < cp)))
+			continue; // an endpoint on the line of the side is outside the window (the caller rejects those on the boundary)
+		int s0 = sign (p, q, corner (side));
+		int s1 = sign (p, q, corner (side + 1));
+		if (s0 == 0 || s1 == 0)
+			return -1;
+		if (s0 == s1)
+			continue; // the edge crosses the line of the side outside the window
+		const double across = vertical ? dx : dy;
+		if (across * across <= 0.0000001 * (dx * dx + dy * dy))
+			return -1;
+		Crossing& cr = out[n++];
+		cr.side = side;
+		cr.t = (c - cp) / (cq - cp);
+		if (vertical) {
+			double y = a.y () + (c - a.x ()) * dy / dx;
+			if (y <= box.ymin () || y >= box.ymax ())
+				return -1;
+			cr.point = Point_2 (c, y);
+			cr.key = (side == 1) ? y : -y;
+		} else {
+			double x = a.x () + (c - a.y ()) * dx / dy;
+			if (x <= box.xmin () || x >= box.xmax ())
+				return -1;
+			cr.point = Point_2 (x, c);
+			cr.key = (side == 0) ? x : -x;
+		}
+		if (cr.point.dist (p) < 0.00000001 || cr.point.dist (q) < 0.00000001 ||
+		    cr.point.dist (corner (side)) < 0.00000001 || cr.point.dist (corner (side + 1)) < 0.00000001)
+			return -1;
+	}
+	if (n == 2) {
+		if (out[0].t == out[1].t)
+			return -1;
+		if (out[1].t < out[0].t)
+			std::swap (out[0], out[1]);
+	}
+	return n;
+}
+
+/** Order of the crossings along the boundary of the window */
+struct AlongBoundary {
+	explicit AlongBoundary (const std::vector<Crossing>& c) : crossings (c) {}
+	bool operator() (unsigned int a, unsigned int b) const
+	{
+		return crossings[a].side < crossings[b].side || (crossings[a].side == crossings[b].side && crossings[a].key < crossings[b].key);
+	}
+	const std::vector<Crossing>& crossings;
+};
+
+/** Order of the contours by their first vertex */
+struct FirstVertexOrder {
+	FirstVertexOrder (const std::vector<Point_2>& p, const std::vector<unsigned int>& s) : points (p), start (s) {}
+	bool operator() (unsigned int a, unsigned int b) const { return lessXY (points[start[a]], points[start[b]]); }
+	const std::vector<Point_2>& points;
+	const std::vector<unsigned int>& start;
+};
+
+/** @brief Clipper of a polygon to a window
+ *
+ * The parts of the edges inside the window form chains, that go from a crossing into the window to the next
+ * crossing. Going along the boundary, every crossing toggles between the parts inside and outside the polygon,
+ * so the parts inside are known from the position of the corner 0. They join the chains into contours.
+ */
+class RectangleClipper {
+public:
+	RectangleClipper (const Polygon& polygon, const Bbox_2& box) : pol (polygon), window (box), cornerInside (false) {}
+	/** Add the intersection to result. Return false, leaving result unmodified, if the clipper gives up */
+	bool clip (Polygon& result);
+private:
+	/** A vertex inside the window or a crossing of the contour being clipped */
+	struct Item {
+		Item (const Point_2& p, int c) : point (p), crossing (c) {}
+		Point_2 point;
+		int crossing; // index of the crossing, -1 for a vertex
+	};
+	const Polygon& pol;
+	Window window;
+	bool cornerInside; // is the corner 0 of the window inside pol?
+	std::vector<Item> items;
+	std::vector<Crossing> contourCrossings;
+	std::vector<Point_2> chainPoints;
+	std::vector<unsigned int> chainStart;  // chain i is [chainStart[i], chainStart[i + 1]) in chainPoints
+	std::vector<Crossing> crossings;       // 2 i and 2 i + 1 are the first and the last points of the chain i
+	std::vector<unsigned int> nested;      // contours of pol strictly inside the window
+	// Result contours, counterclockwise from their leftmost (lowest) vertex
+	std::vector<Point_2> points;
+	std::vector<unsigned int> contourStart; // contour i is [contourStart[i], contourStart[i + 1]) in points
+	unsigned int firstNested;               // the contours from firstNested on are the nested ones
+	/** Clip the edges of pol, computing the chains, the nested contours and cornerInside */
+	bool clipEdges ();
+	/** Join the chains and the window boundary into contours, and add the nested contours */
+	bool connectChains ();
+	/** Add the corners passed going counterclockwise from the crossing at position r to the next one */
+	void addCorners (const std::vector<unsigned int>& order, unsigned int r, bool reversed);
+	/** Start the contours at their leftmost (lowest) vertex and orient them counterclockwise */
+	bool normalize ();
+	/** @brief Closest result edge below the first vertex of the contour c that is not vertical, as the edge below
+	 * it in the status line of the sweep. Return false if the vertex is on an edge
+	 *
+	 * lower is the contour of the edge, -1 if there is no edge, and bottom tells if the interior of the contour
+	 * is above the edge
+	 */
+	bool edgeBelow (unsigned int c, int& lower, bool& bottom) const;
+};
+
+bool RectangleClipper::clip (Polygon& result)
+{
+	if (!clipEdges () || nested.size () > maxNestedContours || !connectChains () || !normalize ())
+		return false;
+	const unsigned int n = contourStart.size () - 1;
+	std::vector<unsigned int> sorted (n);
+	for (unsigned int i = 0; i < n; i++)
+		sorted[i] = i;
+	std::sort (sorted.begin (), sorted.end (), FirstVertexOrder (points, contourStart));
+	for (unsigned int i = 1; i < n; i++)
+		if (points[contourStart[sorted[i - 1]]] == points[contourStart[sorted[i]]])
+			return false; // contours touching at their first vertex
+	std::vector<int> lower (n, -1);
+	std::vector<bool> bottom (n, false);
+	for (unsigned int i = firstNested; i < n; i++) {
+		bool b = false;
+		if (!edgeBelow (i, lower[i], b))
+			return false;
+		bottom[i] = b;
+	}
+	// Add the contours in the order of their first vertex, finding their holes as BooleanOpImp::connectEdges
+	const unsigned int firstContour = result.ncontours ();
+	std::vector<unsigned int> resultId (n);
+	std::vector<int> depth (n, 0);
+	std::vector<int> holeOf (n, -1);
+	for (unsigned int r = 0; r < n; r++)
+		resultId[sorted[r]] = firstContour + r;
+	for (unsigned int r = 0; r < n; r++) {
+		const unsigned int i = sorted[r];
+		Contour& contour = result.emplace_back ();
+		for (unsigned int j = contourStart[i]; j < contourStart[i + 1]; j++)
+			contour.add (points[j]);
+		if (lower[i] >= 0) {
+			const unsigned int l = lower[i];
+			if (bottom[i]) {
+				result[resultId[l]].addHole (resultId[i]);
+				holeOf[i] = l;
+				depth[i] = depth[l] + 1;
+				contour.setExternal (false);
+			} else if (!result[resultId[l]].external ()) {
+				result[resultId[holeOf[l]]].addHole (resultId[i]);
+				holeOf[i] = holeOf[l];
+				depth[i] = depth[l];
+				contour.setExternal (false);
+			}
+		}
+		if (depth[i] & 1)
+			contour.changeOrientation ();
+	}
+	return true;
+}
+
+bool RectangleClipper::clipEdges ()
+{
+	for (unsigned int i = 0; i < pol.ncontours (); i++) {
+		const Contour& c = pol[i];
+		const unsigned int n = c.nvertices ();
+		if (n < 3)
+			return false;
+		Contour::const_iterator v = c.begin ();
+		int location = window.locate (v[0]);
+		if (location < 0)
+			return false;
+		const bool firstInside = location > 0;
+		bool inside = firstInside;
+		int firstEntry = -1;
+		items.clear ();
+		contourCrossings.clear ();
+		for (unsigned int j = 0; j < n; j++) {
+			const Point_2& p = v[j];
+			const Point_2& q = v[(j + 1 < n) ? j + 1 : 0];
+			if (p == q)
+				return false;
+			int ray = window.crossesRay (p, q);
+			if (ray < 0)
+				return false;
+			if (ray)
+				cornerInside = !cornerInside;
+			if (inside)
+				items.push_back (Item (p, -1));
+			Crossing cr[2];
+			int k = window.crossings (p, q, cr);
+			if (k < 0)
+				return false;
+			for (int l = 0; l < k; l++) {
+				inside = !inside;
+				if (inside && firstEntry < 0)
+					firstEntry = items.size ();
+				items.push_back (Item (cr[l].point, contourCrossings.size ()));
+				contourCrossings.push_back (cr[l]);
+			}
+			location = window.locate (q);
+			if (location < 0 || (location > 0) != inside)
+				return false;
+		}
+		if (contourCrossings.empty ()) {
+			if (firstInside)
+				nested.push_back (i);
+			continue;
+		}
+		// the chains, from the first crossing into the window on. A crossing out of the window is followed by a crossing into it
+		bool inChain = false;
+		for (size_t m = 0, j = firstEntry; m < items.size (); m++, j = (j + 1 < items.size ()) ? j + 1 : 0) {
+			if (items[j].crossing >= 0) {
+				inChain = !inChain;
+				if (inChain)
+					chainStart.push_back (chainPoints.size ());
+				crossings.push_back (contourCrossings[items[j].crossing]);
+			}
+			chainPoints.push_back (items[j].point);
+		}
+	}
+	chainStart.push_back (chainPoints.size ());
+	return true;
+}
+
+void RectangleClipper::addCorners (const std::vector<unsigned int>& order, unsigned int r, bool reversed)
+{
+	const unsigned int next = (r + 1 < order.size ()) ? r + 1 : 0;
+	const int a = crossings[order[r]].side;
+	const int count = crossings[order[next]].side - a + (next == 0 ? 4 : 0);
+	for (int i = 1; i <= count; i++)
+		points.push_back (window.corner (reversed ? a + count + 1 - i : a + i));
+}
+
+bool RectangleClipper::connectChains ()
+{
+	const unsigned int k = crossings.size ();
+	if (k == 0) {
+		if (cornerInside) {
+			contourStart.push_back (points.size ());
+			for (int i = 0; i < 4; i++)
+				points.push_back (window.corner (i));
+		}
+	} else {
+		std::vector<unsigned int> order (k);
+		for (unsigned int i = 0; i < k; i++)
+			order[i] = i;
+		AlongBoundary along (crossings);
+		std::sort (order.begin (), order.end (), along);
+		std::vector<unsigned int> rank (k);
+		for (unsigned int r = 0; r < k; r++) {
+			if (r > 0 && !along (order[r - 1], order[r]))
+				return false; // two crossings at the same point
+			rank[order[r]] = r;
+		}
+		std::vector<bool> visited (k / 2, false);
+		for (unsigned int first = 0; first < k / 2; first++) {
+			if (visited[first])
+				continue;
+			contourStart.push_back (points.size ());
+			unsigned int chain = first;
+			unsigned int end = 0; // the end of the chain where the contour enters it
+			do {
+				visited[chain] = true;
+				if (end == 0)
+					points.insert (points.end (), chainPoints.begin () + chainStart[chain], chainPoints.begin () + chainStart[chain + 1]);
+				else
+					points.insert (points.end (), chainPoints.rbegin () + (chainPoints.size () - chainStart[chain + 1]),
+					               chainPoints.rbegin () + (chainPoints.size () - chainStart[chain]));
+				// the part of the boundary inside the polygon that starts at the other end of the chain
+				unsigned int r = rank[2 * chain + 1 - end];
+				// the parts after the crossings at even positions are inside if the corner 0 is not
+				if (cornerInside != (r % 2 == 0)) {
+					addCorners (order, r, false);
+					r = (r + 1 < k) ? r + 1 : 0;
+				} else {
+					r = (r > 0) ? r - 1 : k - 1;
+					addCorners (order, r, true);
+				}
+				chain = order[r] / 2;
+				end = order[r] % 2;
+			} while (!visited[chain]);
+			if (chain != first || end != 0)
+				return false;
+		}
+	}
+	firstNested = contourStart.size ();
+	for (unsigned int i = 0; i < nested.size (); i++) {
+		contourStart.push_back (points.size ());
+		points.insert (points.end (), pol[nested[i]].begin (), pol[nested[i]].end ());
+	}
+	contourStart.push_back (points.size ());
+	return true;
+}
+
+bool RectangleClipper::normalize ()
+{
+	for (unsigned int i = 0; i + 1 < contourStart.size (); i++) {
+		std::vector<Point_2>::iterator begin = points.begin () + contourStart[i];
+		std::vector<Point_2>::iterator end = points.begin () + contourStart[i + 1];
+		std::vector<Point_2>::iterator first = std::min_element (begin, end, lessXY<Point_2>);
+		const Point_2& prev = (first == begin) ? *(end - 1) : *(first - 1);
+		const Point_2& next = (first + 1 == end) ? *begin : *(first + 1);
+		int turn = sign (prev, *first, next); // the leftmost vertex is convex
+		if (turn == 0)
+			return false;
+		std::rotate (begin, first, end);
+		if (turn < 0)
+			std::reverse (begin + 1, end);
+	}
+	return true;
+}
+
+bool RectangleClipper::edgeBelow (unsigned int c, int& lower, bool& bottom) const
+{
+	const Point_2& v = points[contourStart[c]];
+	const Point_2* bestLeft = 0;
+	const Point_2* bestRight = 0;
+	lower = -1;
+	for (unsigned int i = 0; i + 1 < contourStart.size (); i++)
+		for (unsigned int j = contourStart[i]; j < contourStart[i + 1]; j++) {
+			const Point_2& p = points[j];
+			const Point_2& q = points[(j + 1 < contourStart[i + 1]) ? j + 1 : contourStart[i]];
+			if (p.x () == q.x ())
+				continue;
+			const Point_2& l = (p.x () < q.x ()) ? p : q;
+			const Point_2& r = (p.x () < q.x ()) ? q : p;
+			// the edges in the status line when the first edge of the contour is inserted
+			if (!lessXY (l, v) || r.x () <= v.x ())
+				continue;
+			int s = sign (l, r, v);
+			if (s == 0)
+				return false;
+			if (s < 0)
+				continue; // above v
+			if (bestLeft) {
+				// is the edge (l, r) above the best edge so far? Both are below v and do not cross
+				int above = lessXY (*bestLeft, l) ? sign (*bestLeft, *bestRight, l) : (*bestLeft == l) ? sign (*bestLeft, *bestRight, r) : -sign (l, r, *bestLeft);
+				if (above == 0)
+					return false;
+				if (above < 0)
+					continue;
+			}
+			bestLeft = &l;
+			bestRight = &r;
+			lower = i;
+			bottom = p.x () < q.x (); // the contours are counterclockwise: the interior is to the left of the edges
+		}
+	return true;
+}
+
+/** Is p an axis-aligned rectangle? */
+bool rectangle (const Polygon& p)
+{
+	if (p.ncontours () != 1 || p[0].nvertices () != 4)
+		return false;
+	Contour::const_iterator v = p[0].begin ();
+	const Bbox_2 b = p[0].bbox ();
+	if (b.xmin () == b.xmax () || b.ymin () == b.ymax ())
+		return false;
+	// the edges go alternately along the x and the y axis
+	return (v[0].y () == v[1].y () && v[1].x () == v[2].x () && v[2].y () == v[3].y () && v[3].x () == v[0].x ()) ||
+	       (v[0].x () == v[1].x () && v[1].y () == v[2].y () && v[2].x () == v[3].x () && v[3].y () == v[0].y ());
+}
+
+} // end of anonymous namespace
+
+bool cbop::rectangleIntersection (const Polygon& subj, const Polygon& clip, Polygon& result)
+{
+	if (rectangle (subj) && rectangle (clip)) {
+		// the overlap of the windows, whose corners are vertices of the polygons or crossings of an x and a y edge
+		const Bbox_2 a = subj.bbox ();
+		const Bbox_2 b = clip.bbox ();
+		const Bbox_2 overlap (std::max (a.xmin (), b.xmin ()), std::max (a.ymin (), b.ymin ()),
+		                      std::min (a.xmax (), b.xmax ()), std::min (a.ymax (), b.ymax ()));
+		if (overlap.xmin () < overlap.xmax () && overlap.ymin () < overlap.ymax ()) {
+			Window window (overlap);
+			Contour& contour = result.emplace_back ();
+			for (int i = 0; i < 4; i++)
+				contour.add (window.corner (i));
+		}
+		return true;
+	}
+	if (rectangle (clip))
+		return rectangleIntersection (subj, clip.bbox (), result);
+	if (rectangle (subj))
+		return rectangleIntersection (clip, subj.bbox (), result);
+	return false;
+}
+
+bool cbop::rectangleIntersection (const Polygon& pol, const Bbox_2& window, Polygon& result)
+{
+	if (window.xmin () >= window.xmax () || window.ymin () >= window.ymax ())
+		return true;
+	RectangleClipper clipper (pol, window);
+	return clipper.clip (result);
+}
@@ -0,0 +1,44 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// Clipping of a polygon to an axis-aligned rectangle
+// ------------------------------------------------------------------
+
+#ifndef RECTANGLE_H
+#define RECTANGLE_H
+
+#include "polygon.h"
+
+namespace cbop {
+
+/** @brief Compute the intersection of subj and clip if one of them is an axis-aligned rectangle (the window)
+ *
+ * The edges of the other polygon are clipped to the window one after another, in time linear in its number of
+ * vertices, and the parts of the window boundary inside the polygon (even-odd rule) are found from the order of
+ * the crossings along the boundary. The contours are added to result as BooleanOpImp adds them: sorted by their
+ * leftmost (lowest) vertex, where they start, with the holes of every contour, counterclockwise at even depths
+ * and clockwise at odd depths.
+ *
+ * The edges of the polygon must not cross each other or share points other than the vertices of consecutive
+ * edges; such inputs need the sweep. The clipper gives up if the polygon touches the window boundary or a
+ * crossing is closer to a vertex than the tolerance of findIntersection, and if more than maxNestedContours
+ * contours lie strictly inside the window (their nesting is found by scanning all the result edges).
+ * If both polygons are rectangles their intersection is the overlap of the windows, computed exactly.
+ * Return false, leaving result unmodified, if no polygon is a rectangle or the clipper gave up
+ */
+bool rectangleIntersection (const Polygon& subj, const Polygon& clip, Polygon& result);
+/** @brief Clip pol to window, as the other rectangleIntersection does, under the same precondition on the edges of pol
+ *
+ * An empty window (without area) clips pol to nothing. Return false, leaving result unmodified, if the clipper gave up
+ */
+bool rectangleIntersection (const Polygon& pol, const Bbox_2& window, Polygon& result);
+const unsigned int maxNestedContours = 32;
+
+} // end of namespace cbop
+#endif
@@ -0,0 +1,336 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// StatusLine Class - Intrusive red-black tree for the sweep line status
+// ------------------------------------------------------------------
+
+#ifndef STATUSLINE_H
+#define STATUSLINE_H
+
+#include <cstddef>
+
+namespace cbop {
+
+/** @brief Links of an element in a StatusLine. They are embedded into the element, so the tree never allocates memory
+ *
+ * The colour of the node is not stored here but in the member red of the element, that can be a one-bit bit-field
+ * packed with the flags of the element: a bool here would take a whole word of padding
+ */
+template <class T>
+struct SLNode {
+	SLNode () : parent (0), leftChild (0), rightChild (0), prev (0), next (0) {}
+	T* parent;
+	T* leftChild;
+	T* rightChild;
+	T* prev;  // previous element in the tree order
+	T* next;  // next element in the tree order
+};
+
+/** @brief Balanced tree of the elements T intersecting the sweep line, sorted by Comp
+ *
+ * The node of an element is the member Node of T and its colour the member red, so insertion and removal do not
+ * allocate memory and the neighbors of an element are reached in constant time. Insertion and rebalancing follow
+ * the same steps as std::set, so the ordering of the elements is identical to the one obtained with std::set.
+ */
+template <class T, class Comp, SLNode<T> T::*Node>
+class StatusLine {
+public:
+	class const_iterator {
+	public:
+		const_iterator (T* ev = 0) : e (ev) {}
+		T* operator* () const { return e; }
+		const_iterator& operator++ () { e = (e->*Node).next; return *this; }
+		bool operator== (const const_iterator& it) const { return e == it.e; }
+		bool operator!= (const const_iterator& it) const { return e != it.e; }
+	private:
+		T* e;
+	};
+
+	StatusLine (const Comp& c = Comp ()) : comp (c), root (0), _first (0), _last (0), _size (0) {}
+
+	/** Insert e into the tree. If an equivalent element is already in the tree e is not inserted and that element is returned */
+	T* insert (T* e);
+	/** Remove e, that must belong to the tree */
+	void erase (T* e);
+	void clear () { root = _first = _last = 0; _size = 0; }
+
+	bool empty () const { return _size == 0; }
+	size_t size () const { return _size; }
+	/** First and last elements of the tree, 0 if the tree is empty */
+	T* first () const { return _first; }
+	T* last () const { return _last; }
+	/** Neighbors of e in the tree, 0 if they do not exist */
+	static T* prev (T* e) { return (e->*Node).prev; }
+	static T* next (T* e) { return (e->*Node).next; }
+
+	const_iterator begin () const { return const_iterator (_first); }
+	const_iterator end () const { return const_iterator (); }
+
+private:
+	Comp comp;
+	T* root;
+	T* _first;
+	T* _last;
+	size_t _size;
+
+	static SLNode<T>& node (T* e) { return e->*Node; }
+	static T* parent (T* e) { return node (e).parent; }
+	static void setParent (T* e, T* p) { node (e).parent = p; }
+	static bool isRed (T* e) { return e && e->red; }
+	static void setRed (T* e, bool red) { e->red = red; }
+	void rotateLeft (T* x);
+	void rotateRight (T* x);
+	/** Put the subtree rooted at y in the place of the subtree rooted at x */
+	void replaceChild (T* x, T* y);
+};
+
+template <class T, class Comp, SLNode<T> T::*Node>
+void StatusLine<T, Comp, Node>::replaceChild (T* x, T* y)
+{
+	T* p = parent (x);
+	if (!p)
+		root = y;
+	else if (node (p).leftChild == x)
+		node (p).leftChild = y;
+	else
+		node (p).rightChild = y;
+}
+
+template <class T, class Comp, SLNode<T> T::*Node>
+void StatusLine<T, Comp, Node>::rotateLeft (T* x)
+{
+	T* y = node (x).rightChild;
+	node (x).rightChild = node (y).leftChild;
+	if (node (y).leftChild)
+		setParent (node (y).leftChild, x);
+	replaceChild (x, y);
+	setParent (y, parent (x));
+	node (y).leftChild = x;
+	setParent (x, y);
+}
+
+template <class T, class Comp, SLNode<T> T::*Node>
+void StatusLine<T, Comp, Node>::rotateRight (T* x)
+{
+	T* y = node (x).leftChild;
+	node (x).leftChild = node (y).rightChild;
+	if (node (y).rightChild)
+		setParent (node (y).rightChild, x);
+	replaceChild (x, y);
+	setParent (y, parent (x));
+	node (y).rightChild = x;
+	setParent (x, y);
+}
+
+template <class T, class Comp, SLNode<T> T::*Node>
+T* StatusLine<T, Comp, Node>::insert (T* e)
+{
+	// find the parent of the new node
+	T* p = 0;
+	T* x = root;
+	bool goLeft = true;
+	while (x) {
+		p = x;
+		goLeft = comp (e, x);
+		x = goLeft ? node (x).leftChild : node (x).rightChild;
+	}
+	// check that there is not an equivalent element
+	T* pred = (goLeft) ? (p ? node (p).prev : 0) : p;
+	if (pred && !comp (pred, e))
+		return pred;
+
+	SLNode<T>& n = node (e);
+	n.parent = p;
+	e->red = true; // new nodes are red
+	n.leftChild = n.rightChild = 0;
+	if (!p) {
+		root = _first = _last = e;
+		n.prev = n.next = 0;
+	} else if (goLeft) {
+		node (p).leftChild = e;
+		n.prev = node (p).prev;
+		n.next = p;
+	} else {
+		node (p).rightChild = e;
+		n.prev = p;
+		n.next = node (p).next;
+	}
+	if (n.prev)
+		node (n.prev).next = e;
+	else
+		_first = e;
+	if (n.next)
+		node (n.next).prev = e;
+	else
+		_last = e;
+	++_size;
+
+	// rebalance
+	x = e;
+	while (x != root && isRed (parent (x))) {
+		T* xp = parent (x);
+		T* xpp = parent (xp);
+		if (xp == node (xpp).leftChild) {
+			T* y = node (xpp).rightChild;
+			if (isRed (y)) {
+				setRed (xp, false);
+				setRed (y, false);
+				setRed (xpp, true);
+				x = xpp;
+			} else {
+				if (x == node (xp).rightChild) {
+					x = xp;
+					rotateLeft (x);
+					xp = parent (x);
+				}
+				setRed (xp, false);
+				setRed (xpp, true);
+				rotateRight (xpp);
+			}
+		} else {
+			T* y = node (xpp).leftChild;
+			if (isRed (y)) {
+				setRed (xp, false);
+				setRed (y, false);
+				setRed (xpp, true);
+				x = xpp;
+			} else {
+				if (x == node (xp).leftChild) {
+					x = xp;
+					rotateRight (x);
+					xp = parent (x);
+				}
+				setRed (xp, false);
+				setRed (xpp, true);
+				rotateLeft (xpp);
+			}
+		}
+	}
+	setRed (root, false);
+	return e;
+}
+
+template <class T, class Comp, SLNode<T> T::*Node>
+void StatusLine<T, Comp, Node>::erase (T* z)
+{
+	SLNode<T>& nz = node (z);
+	T* zParent = parent (z);
+	// unlink z from the list of elements
+	if (nz.prev)
+		node (nz.prev).next = nz.next;
+	else
+		_first = nz.next;
+	if (nz.next)
+		node (nz.next).prev = nz.prev;
+	else
+		_last = nz.prev;
+	--_size;
+
+	// y is the node removed from the tree structure, x the node that takes its place
+	T* y = z;
+	T* x;
+	T* xParent;
+	if (!nz.leftChild)
+		x = nz.rightChild;
+	else if (!nz.rightChild)
+		x = nz.leftChild;
+	else {
+		y = nz.next; // successor of z, it has no left child
+		x = node (y).rightChild;
+	}
+	bool removedRed;
+	if (y != z) { // relink y in the place of z
+		setParent (nz.leftChild, y);
+		node (y).leftChild = nz.leftChild;
+		if (y != nz.rightChild) {
+			xParent = parent (y);
+			if (x)
+				setParent (x, xParent);
+			node (xParent).leftChild = x;
+			node (y).rightChild = nz.rightChild;
+			setParent (nz.rightChild, y);
+		} else {
+			xParent = y;
+		}
+		replaceChild (z, y);
+		setParent (y, zParent);
+		removedRed = isRed (y);
+		setRed (y, isRed (z));
+	} else {
+		xParent = zParent;
+		if (x)
+			setParent (x, xParent);
+		replaceChild (z, x);
+		removedRed = isRed (z);
+	}
+	if (removedRed)
+		return;
+
+	// rebalance
+	while (x != root && !isRed (x)) {
+		if (x == node (xParent).leftChild) {
+			T* w = node (xParent).rightChild;
+			if (isRed (w)) {
+				setRed (w, false);
+				setRed (xParent, true);
+				rotateLeft (xParent);
+				w = node (xParent).rightChild;
+			}
+			if (!isRed (node (w).leftChild) && !isRed (node (w).rightChild)) {
+				setRed (w, true);
+				x = xParent;
+				xParent = parent (xParent);
+			} else {
+				if (!isRed (node (w).rightChild)) {
+					setRed (node (w).leftChild, false);
+					setRed (w, true);
+					rotateRight (w);
+					w = node (xParent).rightChild;
+				}
+				setRed (w, isRed (xParent));
+				setRed (xParent, false);
+				if (node (w).rightChild)
+					setRed (node (w).rightChild, false);
+				rotateLeft (xParent);
+				break;
+			}
+		} else {
+			T* w = node (xParent).leftChild;
+			if (isRed (w)) {
+				setRed (w, false);
+				setRed (xParent, true);
+				rotateRight (xParent);
+				w = node (xParent).leftChild;
+			}
+			if (!isRed (node (w).rightChild) && !isRed (node (w).leftChild)) {
+				setRed (w, true);
+				x = xParent;
+				xParent = parent (xParent);
+			} else {
+				if (!isRed (node (w).leftChild)) {
+					setRed (node (w).rightChild, false);
+					setRed (w, true);
+					rotateLeft (w);
+					w = node (xParent).leftChild;
+				}
+				setRed (w, isRed (xParent));
+				setRed (xParent, false);
+				if (node (w).leftChild)
+					setRed (node (w).leftChild, false);
+				rotateRight (xParent);
+				break;
+			}
+		}
+	}
+	if (x)
+		setRed (x, false);
+}
+
+} // end of namespace cbop
+#endif
@@ -0,0 +1,186 @@
+/***************************************************************************
+ *   Developer: Francisco Martínez del Río (2012)                          *
+ *   fmartin@ujaen.es                                                      *
+ *   Version: 1.0                                                          *
+ *                                                                         *
+ *   This is a public domain program                                       *
+ ***************************************************************************/
+
+// ------------------------------------------------------------------
+// Reader of the polygon text format, shared by Polygon and FlatPolygon
+// ------------------------------------------------------------------
+
+#ifndef TEXTREADER_H
+#define TEXTREADER_H
+
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include "point_2.h"
+
+namespace cbop {
+
+/** @brief Contents of a file, mapped into memory if the system allows it. Used as well for the binary polygon files */
+class FileText {
+public:
+	explicit FileText (const std::string& filename);
+	~FileText ();
+	FileText (const FileText&) = delete;
+	FileText& operator= (const FileText&) = delete;
+	/** Could the file be read? */
+	bool good () const { return _good; }
+	const char* begin () const { return data; }
+	const char* end () const { return data + size; }
+private:
+	const char* data;
+	size_t size;
+	std::string buffer; // the text, if the file is not mapped
+	bool _good;
+};
+
+/** @brief Reader of the numbers of the polygon text format, with the syntax of operator>> of the C++ streams
+ *
+ * The numbers are read with std::from_chars, which does not depend on the locale. As the stream operators, it
+ * accepts a leading '+' and does not accept "inf" nor "nan"
+ */
+class TextReader {
+public:
+	TextReader (const char* first, const char* last) : p (first), end (last) {}
+	/** Skip the white space. Return if the end of the text has been reached */
+	bool atEnd () { skipSpace (); return p == end; }
+	/** Read the next character that is not white space */
+	bool read (char& c)
+	{
+		if (atEnd ())
+			return false;
+		c = *p++;
+		return true;
+	}
+	bool read (int& n)
+	{
+		if (!skipSign ())
+			return false;
+		std::from_chars_result r = std::from_chars (p, end, n);
+		p = r.ptr;
+		return r.ec == std::errc ();
+	}
+	bool read (double& d)
+	{
+		if (!skipSign ())
+			return false;
+		const char* digits = (*p == '-') ? p + 1 : p;
+		if (digits == end || (*digits != '.' && (*digits < '0' || *digits > '9')))
+			return false;
+		std::from_chars_result r = std::from_chars (p, end, d);
+		if (r.ec == std::errc::result_out_of_range) { // the stream operators round an underflow to zero, and fail on overflow
+			const char* e = std::find_if (p, r.ptr, isExponent);
+			if (e + 1 >= r.ptr || e[1] != '-')
+				return false;
+			d = (*p == '-') ? -0.0 : 0.0;
+			r.ec = std::errc ();
+		}
+		p = r.ptr;
+		return r.ec == std::errc ();
+	}
+	/** Skip the white space up to the end of the line. Return if the end of the line (or the text) has been reached */
+	bool endOfLine ()
+	{
+		while (p != end && *p != '\n' && isSpace (*p))
+			++p;
+		if (p == end)
+			return true;
+		if (*p != '\n')
+			return false;
+		++p;
+		return true;
+	}
+	/** Upper bound of the number of numbers left in the text */
+	size_t numbersLeft () const { return (end - p) / 2 + 1; }
+private:
+	static bool isExponent (char c) { return c == 'e' || c == 'E'; }
+	static bool isSpace (char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; }
+	void skipSpace ()
+	{
+		while (p != end && isSpace (*p))
+			++p;
+	}
+	/** Skip the white space and a '+' sign. Return false if no number can follow */
+	bool skipSign ()
+	{
+		skipSpace ();
+		if (p != end && *p == '+' && ++p != end && *p == '-')
+			return false;
+		return p != end;
+	}
+	const char* p;
+	const char* end;
+};
+
+/** @brief Read the polygon written in the text [first, last), in the format read by Polygon::open, into builder
+ *
+ * Consecutive repeated vertices are removed, as well as the last vertex of a contour if it repeats the first one,
+ * and the contours left with less than 3 vertices are discarded. The builder already has existing contours; the
+ * hole lines refer to the contours by their index in the builder. Builder provides reserve (ncontours),
+ * beginContour (nvertices), add (point), endContour (), discardContour () and addHole (contour, hole).
+ * Return false if the text has a bad format
+ */
+template <class Builder>
+bool readPolygonText (const char* first, const char* last, unsigned int existing, Builder& builder)
+{
+	TextReader reader (first, last);
+	// read the contours
+	int n = 0;
+	if (!reader.atEnd () && !reader.read (n))
+		return false;
+	if (n > 0)
+		builder.reserve (std::min<size_t> (n, reader.numbersLeft ()));
+	unsigned int ncontours = existing;
+	double px, py;
+	for (int i = 0; i < n; i++) {
+		int npoints;
+		if (!reader.read (npoints))
+			return false;
+		builder.beginContour (npoints > 0 ? std::min<size_t> (npoints, reader.numbersLeft () / 2) : 0);
+		Point_2 front, back;
+		unsigned int added = 0;
+		for (int j = 0; j < npoints; j++) {
+			if (!reader.read (px) || !reader.read (py)) {
+				builder.discardContour ();
+				return false;
+			}
+			if (j > 0 && px == back.x () && py == back.y ())
+				continue;
+			if (j == npoints-1 && j > 0 && px == front.x () && py == front.y ())
+				continue;
+			back = Point_2 (px, py);
+			if (added++ == 0)
+				front = back;
+			builder.add (back);
+		}
+		if (added < 3) {
+			builder.discardContour ();
+		} else {
+			builder.endContour ();
+			++ncontours;
+		}
+	}
+	// read holes information: lines "contour: hole hole ..."
+	int contourId;
+	char aux;
+	while (!reader.atEnd ()) {
+		if (!reader.read (contourId) || !reader.read (aux) || aux != ':')
+			return false;
+		if (contourId < 0 || contourId >= static_cast<int> (ncontours))
+			return false;
+		int hole;
+		while (!reader.endOfLine ()) {
+			if (!reader.read (hole) || hole < 0 || hole >= static_cast<int> (ncontours))
+				return false;
+			builder.addHole (contourId, hole);
+		}
+	}
+	return true;
+}
+
+} // end of namespace cbop
+#endif
@@ -11,6 +11,183 @@
 
 using namespace cbop;
 
+// Exact arithmetic on expansions (J. R. Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust
+// Geometric Predicates", 1997). An expansion is a sum of nonoverlapping doubles sorted by increasing magnitude
+
+namespace {
+
+const double epsilon = 1.1102230246251565e-16;                          // 2^-53
+const double splitter = 134217729.0;                                    // 2^27 + 1
+const double resultErrBound = (3.0 + 8.0 * epsilon) * epsilon;
+const double ccwErrBoundB = (2.0 + 12.0 * epsilon) * epsilon;
+const double ccwErrBoundC = (9.0 + 64.0 * epsilon) * epsilon * epsilon;
+
+/** x + y = a + b exactly, |a| >= |b| */
+inline void fastTwoSum (double a, double b, double& x, double& y)
+{
+	x = a + b;
+	y = b - (x - a);
+}
+
+/** x + y = a + b exactly */
+inline void twoSum (double a, double b, double& x, double& y)
+{
+	x = a + b;
+	double bv = x - a;
+	double av = x - bv;
+	y = (a - av) + (b - bv);
+}
+
+/** y is the rounding error of x = a - b */
+inline void twoDiffTail (double a, double b, double x, double& y)
+{
+	double bv = a - x;
+	double av = x + bv;
+	y = (a - av) + (bv - b);
+}
+
+/** x + y = a - b exactly */
+inline void twoDiff (double a, double b, double& x, double& y)
+{
+	x = a - b;
+	twoDiffTail (a, b, x, y);
+}
+
+/** a = hi + lo, both with at most 26 significant bits */
+inline void split (double a, double& hi, double& lo)
+{
+	double c = splitter * a;
+	hi = c - (c - a);
+	lo = a - hi;
+}
+
+/** x + y = a * b exactly */
+inline void twoProduct (double a, double b, double& x, double& y)
+{
+	x = a * b;
+	double ahi, alo, bhi, blo;
+	split (a, ahi, alo);
+	split (b, bhi, blo);
+	y = alo * blo - (((x - ahi * bhi) - alo * bhi) - ahi * blo);
+}
+
+/** x = (a1 + a0) - (b1 + b0) exactly, as an expansion of four components */
+inline void twoTwoDiff (double a1, double a0, double b1, double b0, double x[4])
+{
+	double i, j, k;
+	twoDiff (a0, b0, i, x[0]);
+	twoSum (a1, i, j, k);
+	twoDiff (k, b1, i, x[1]);
+	twoSum (j, i, x[3], x[2]);
+}
+
+/** h = e + f, zero components are eliminated. Returns the number of components of h */
+int expansionSum (int elen, const double* e, int flen, const double* f, double* h)
+{
+	double q, qnew, hh;
+	int ei = 0, fi = 0, hi = 0;
+	double enow = e[0];
+	double fnow = f[0];
+	if ((fnow > enow) == (fnow > -enow)) {
+		q = enow;
+		enow = (++ei < elen) ? e[ei] : 0.0;
+	} else {
+		q = fnow;
+		fnow = (++fi < flen) ? f[fi] : 0.0;
+	}
+	if (ei < elen && fi < flen) {
+		if ((fnow > enow) == (fnow > -enow)) {
+			fastTwoSum (enow, q, qnew, hh);
+			enow = (++ei < elen) ? e[ei] : 0.0;
+		} else {
+			fastTwoSum (fnow, q, qnew, hh);
+			fnow = (++fi < flen) ? f[fi] : 0.0;
+		}
+		q = qnew;
+		if (hh != 0.0)
+			h[hi++] = hh;
+		while (ei < elen && fi < flen) {
+			if ((fnow > enow) == (fnow > -enow)) {
+				twoSum (q, enow, qnew, hh);
+				enow = (++ei < elen) ? e[ei] : 0.0;
+			} else {
+				twoSum (q, fnow, qnew, hh);
+				fnow = (++fi < flen) ? f[fi] : 0.0;
+			}
+			q = qnew;
+			if (hh != 0.0)
+				h[hi++] = hh;
+		}
+	}
+	while (ei < elen) {
+		twoSum (q, enow, qnew, hh);
+		enow = (++ei < elen) ? e[ei] : 0.0;
+		q = qnew;
+		if (hh != 0.0)
+			h[hi++] = hh;
+	}
+	while (fi < flen) {
+		twoSum (q, fnow, qnew, hh);
+		fnow = (++fi < flen) ? f[fi] : 0.0;
+		q = qnew;
+		if (hh != 0.0)
+			h[hi++] = hh;
+	}
+	if (q != 0.0 || hi == 0)
+		h[hi++] = q;
+	return hi;
+}
+
+} // end of anonymous namespace
+
+double cbop::signedAreaAdaptive (const Point_2& p0, const Point_2& p1, const Point_2& p2, double detsum)
+{
+	double acx = p0.x () - p2.x ();
+	double bcx = p1.x () - p2.x ();
+	double acy = p0.y () - p2.y ();
+	double bcy = p1.y () - p2.y ();
+
+	double detLeft, detLeftTail, detRight, detRightTail;
+	twoProduct (acx, bcy, detLeft, detLeftTail);
+	twoProduct (acy, bcx, detRight, detRightTail);
+	double b[4];
+	twoTwoDiff (detLeft, detLeftTail, detRight, detRightTail, b);
+	double det = b[0] + b[1] + b[2] + b[3];
+	double errBound = ccwErrBoundB * detsum;
+	if (det >= errBound || -det >= errBound)
+		return det;
+
+	double acxTail, bcxTail, acyTail, bcyTail;
+	twoDiffTail (p0.x (), p2.x (), acx, acxTail);
+	twoDiffTail (p1.x (), p2.x (), bcx, bcxTail);
+	twoDiffTail (p0.y (), p2.y (), acy, acyTail);
+	twoDiffTail (p1.y (), p2.y (), bcy, bcyTail);
+	if (acxTail == 0.0 && acyTail == 0.0 && bcxTail == 0.0 && bcyTail == 0.0)
+		return det;
+
+	errBound = ccwErrBoundC * detsum + resultErrBound * (det >= 0.0 ? det : -det);
+	det += (acx * bcyTail + bcy * acxTail) - (acy * bcxTail + bcx * acyTail);
+	if (det >= errBound || -det >= errBound)
+		return det;
+
+	// exact computation
+	double s1, s0, t1, t0, u[4];
+	double c1[8], c2[12], d[16];
+	twoProduct (acxTail, bcy, s1, s0);
+	twoProduct (acyTail, bcx, t1, t0);
+	twoTwoDiff (s1, s0, t1, t0, u);
+	int c1len = expansionSum (4, b, 4, u, c1);
+	twoProduct (acx, bcyTail, s1, s0);
+	twoProduct (acy, bcxTail, t1, t0);
+	twoTwoDiff (s1, s0, t1, t0, u);
+	int c2len = expansionSum (c1len, c1, 4, u, c2);
+	twoProduct (acxTail, bcyTail, s1, s0);
+	twoProduct (acyTail, bcxTail, t1, t0);
+	twoTwoDiff (s1, s0, t1, t0, u);
+	int dlen = expansionSum (c2len, c2, 4, u, d);
+	return d[dlen - 1];
+}
+
 static int findIntersection (double u0, double u1, double v0, double v1, double w[2])
 {
 	if ((u1 < v0) || (u0 > v1))
@@ -12,6 +12,8 @@
 #define UTILITIES_H
 
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include "point_2.h"
 #include "segment_2.h"
 
@@ -19,22 +21,42 @@ namespace cbop {
 
 int findIntersection (const Segment_2& seg0, const Segment_2& seg1, Point_2& ip0, Point_2& ip1);
 
-/** Signed area of the triangle (p0, p1, p2) */
-inline float signedArea (const Point_2& p0, const Point_2& p1, const Point_2& p2)
-{ 
-	return (p0.x ()- p2.x ())*(p1.y () - p2.y ()) - (p1.x () - p2.x ()) * (p0.y () - p2.y ());
+/** @brief Exact signed area of the triangle (p0, p1, p2), computed with expansion arithmetic
+ *
+ * detsum is the sum of the absolute values of the two products of the determinant. Used by signedArea
+ * when the rounding error of the floating point evaluation could change its sign
+ */
+double signedAreaAdaptive (const Point_2& p0, const Point_2& p1, const Point_2& p2, double detsum);
+
+/** @brief Signed area of the triangle (p0, p1, p2)
+ *
+ * The sign is always exact (Shewchuk's adaptive orient2d). The determinant is evaluated in floating point and
+ * returned if it is larger than its error bound; otherwise it is recomputed with increasing precision
+ */
+inline double signedArea (const Point_2& p0, const Point_2& p1, const Point_2& p2)
+{
+	const double ccwErrBoundA = 3.3306690738754716e-16; // (3 + 16 * eps) * eps, eps = 2^-53
+	double detLeft = (p0.x () - p2.x ()) * (p1.y () - p2.y ());
+	double detRight = (p1.x () - p2.x ()) * (p0.y () - p2.y ());
+	double det = detLeft - detRight;
+	double detSum = std::fabs (detLeft) + std::fabs (detRight);
+	if (std::fabs (det) > ccwErrBoundA * detSum)
+		return det;
+	if (detSum == 0.0)
+		return 0.0;
+	return signedAreaAdaptive (p0, p1, p2, detSum);
 }
 
 /** Signed area of the triangle ( (0,0), p1, p2) */
-inline float signedArea (const Point_2& p1, const Point_2& p2)
+inline double signedArea (const Point_2& p1, const Point_2& p2)
 { 
-	return -p2.x ()*(p1.y () - p2.y ()) - -p2.y ()*(p1.x () - p2.x ());
+	return signedArea (Point_2 (0, 0), p1, p2);
 }
 
 /** Sign of triangle (p1, p2, o) */
 inline int sign (const Point_2& p1, const Point_2& p2, const Point_2& o)
 {
-	float det = (p1.x () - o.x ()) * (p2.y () - o.y ()) - (p2.x () - o.x ()) * (p1.y () - o.y ());
+	double det = signedArea (p1, p2, o);
 	return (det < 0 ? -1 : (det > 0 ? +1 : 0));
 }
 